@@ -19,943 +19,5095 @@
 
 #include <string>
 #include <cmath>
+#include <cfloat>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <cerrno>
+#include <limits>
+#include <cstdint>
 #include <map>
+#include <array>
+#include <deque>
+#include <atomic>
+#include <algorithm>
+#include <mutex>
+#include <chrono>
+#include <memory>
+#include <thread>
 #include <vector>
 #include <iostream>
 #include <stdexcept>
+#include <list>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <condition_variable>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#ifdef __linux__
+#include <sys/uio.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
 
 namespace obj
 {
-	static constexpr float epsilon = 1e-6f;
+	// Precision policy, set when building: coordinates in float or double, indices and vertex numbers in 32 or 64 bits.
+	// Point is 16 bytes with float and 32-bit numbers, 24 with float and 64-bit, 32 with double
+
+#ifdef TRIANGULATE_DOUBLE
+	using Real = double; // Coordinates, large world coordinates keep their precision
+#else
+	using Real = float; // Coordinates, the precision most obj files are written with
+#endif
+
+#ifdef TRIANGULATE_INDEX_32
+	using Index  = int32_t;  // Face indices, half the index memory for files below 2^31 vertices
+	using Vertex = uint32_t; // Vertex numbers of polygon corners
+#else
+	using Index  = int64_t; // Face indices, files past 2^31 vertices
+	using Vertex = uint64_t;
+#endif
+
+	static constexpr Real epsilon = static_cast<Real>(1e-6);
+
+	inline int seek(FILE* file, const uint64_t offset, const int origin = SEEK_SET) // 64-bit offsets, long is 32 bits on Windows
+	{
+#ifdef _WIN32
+		return _fseeki64(file, static_cast<__int64>(offset), origin);
+#else
+		return fseeko(file, static_cast<off_t>(offset), origin);
+#endif
+	}
+
+	inline uint64_t tell(FILE* file) // UINT64_MAX on failure
+	{
+#ifdef _WIN32
+		const auto offset = _ftelli64(file);
+#else
+		const auto offset = ftello(file);
+#endif
+		return offset < 0 ? UINT64_MAX : static_cast<uint64_t>(offset);
+	}
 
 	struct Count
 	{
 		bool empty() const { return vertices == 0; }
 
+		Count& operator+=(const Count& other)
+		{
+			vertices += other.vertices;
+
+			polygons.first   += other.polygons.first;
+			polygons.second  += other.polygons.second;
+			triangles.first  += other.triangles.first;
+			triangles.second += other.triangles.second;
+
+			welded += other.welded;
+
+			materials.first  += other.materials.first;
+			materials.second += other.materials.second;
+
+			chunks        += other.chunks;
+			chunkVertices += other.chunkVertices;
+			duplicated    += other.duplicated;
+
+			return *this;
+		}
+
 		size_t vertices = 0;
+		size_t welded   = 0; // Vertices merged into an earlier one, and dropped from the output
 
 		std::pair<size_t, size_t> polygons;
 		std::pair<size_t, size_t> triangles;
+		std::pair<size_t, size_t> materials; // usemtl switches in the source and in the target
+
+		size_t chunks        = 0; // Chunked output
+		size_t chunkVertices = 0; // Vertices of all chunks together
+		size_t duplicated    = 0; // Vertices already in an earlier chunk
 	};
 
-	class Triangulate
+	struct Worker
 	{
-	public:
+		double busy   = 0.0; // Seconds spent running tasks
+		size_t tasks  = 0;
+		size_t steals = 0;
+	};
 
-		explicit Triangulate() : source(nullptr), target(nullptr) {}
+	struct Hash // 64-bit FNV-1a, the same value whether the bytes come in one piece or line by line
+	{
+		void add(const char* data, const size_t size)
+		{
+			for( size_t i = 0; i < size; i++ )
+				value = (value ^ static_cast<unsigned char>(data[i])) * 1099511628211ull;
+		}
 
-		~Triangulate();
+		void add(const std::string& text) { add(text.data(), text.size()); }
 
-		Triangulate(const Triangulate&) = delete;
+		uint64_t value = 14695981039346656037ull;
+	};
 
-		Triangulate(const Triangulate&&) = delete;
+	struct Profile
+	{
+		enum Phase { Prescan, Read, Parse, Store, Triangulation, Format, Write, Phases };
 
-		Triangulate& operator=(const Triangulate&) = delete;
+		struct Bucket
+		{
+			size_t corners; // Faces with up to this many corners (and more than the bucket before)
+			size_t faces;
+			double seconds; // Triangulation and format time, summed over workers
+		};
 
-		Triangulate& operator=(const Triangulate&&) = delete;
+		Profile() : histogram({{3, 0, 0.0}, {4, 0, 0.0}, {8, 0, 0.0}, {16, 0, 0.0}, {64, 0, 0.0}, {256, 0, 0.0}, {1024, 0, 0.0}, {4096, 0, 0.0}, {SIZE_MAX, 0, 0.0}}) {}
 
-		bool triangulate(const std::string& source_obj, const std::string& target_obj);
+		static const char* name(const Phase phase)
+		{
+			static const char* names[Phases] = {"Prescan", "Read", "Parse", "Vertex storage", "Triangulation", "Format", "Write"};
 
-		const Count& metrics() const { return count; }
+			return names[phase];
+		}
 
-		bool empty() const { return count.empty(); }
+		void add(const size_t corners, const double time)
+		{
+			auto bucket = histogram.begin();
 
-	private:
+			while( bucket->corners < corners ) ++bucket;
 
-		Count count;
+			bucket->faces++;
+			bucket->seconds += time;
+		}
 
-		bool triangulate();
+		double seconds[Phases] = {}; // Triangulation and format are summed over workers, the rest is wall time
 
-		bool can_triangulate();
+		std::vector<Bucket> histogram;
 
-		bool write_header(const std::string&);
+		size_t vertexBytes = 0; // Peak capacity of the vertex store, out of core the peak of the blocks in memory
 
-		void close();
+		uint64_t vertexFileBytes = 0; // Out of core, vertices written to the temporary file
+		uint64_t vertexLoads     = 0; // Out of core, blocks read back
+		size_t batchBytes  = 0; // Peak capacity of one batch, lines + faces + formatted text
 
-		bool error();
+		size_t divided = 0; // Polygons split into pieces triangulated in parallel
+		size_t pieces  = 0;
 
-		FILE* source;
-		FILE* target;
-	};
+		uint64_t mappedBytes   = 0; // Mapped output, bytes the workers copied into the target
+		uint64_t mappedWindows = 0; // Mapped output, one per batch
 
-	//-------------------------------------------------------------------------------------------------------
+		uint64_t ringReads  = 0; // io_uring, requests completed
+		uint64_t ringWrites = 0;
+	};
 
-	struct Point
+	class Scheduler
 	{
-		Point() : i(0), x(0.0f), y(0.0f), z(0.0f) {}
+	public:
 
-		Point(const float& x, const float& y, const float& z) : i(0), x(x), y(y), z(z) {}
+		using Range = std::pair<size_t, size_t>;
+		using Task  = std::function<void(size_t, size_t)>;
 
-		size_t i;
-		float  x;
-		float  y;
-		float  z;
-	};
+		explicit Scheduler(size_t threads);
 
-	struct Triangle
-	{
-		Triangle(const Point& p0, const Point& p1, const Point& p2) : p0(p0), p1(p1), p2(p2) {}
+		~Scheduler();
 
-		Point p0, p1, p2;
-	};
+		Scheduler(const Scheduler&) = delete;
 
-	//-------------------------------------------------------------------------------------------------------
+		Scheduler(const Scheduler&&) = delete;
 
-	char* trim(char*);
+		Scheduler& operator=(const Scheduler&) = delete;
 
-	bool iseol(const char&);
+		Scheduler& operator=(const Scheduler&&) = delete;
 
-	bool isspace(const char&);
+		void run(const std::vector<Range>& ranges, const Task& task);
 
-	bool parse(const char*, Point&, Count&);
+		const std::vector<Worker>& workers() const { return worker; }
 
-	char* parse(char* line, std::vector<Point>&, Count&);
+		void reset() { std::fill(worker.begin(), worker.end(), Worker()); } // Between runs only
 
-	bool parse(const char*, std::vector<int>&, const std::vector<Point>&, Count&);
+	private:
 
-	//-------------------------------------------------------------------------------------------------------
+		struct Queue
+		{
+			std::mutex mutex;
+			std::deque<Range> ranges;
+		};
 
-	inline Triangulate::~Triangulate() { close(); }
+		void loop(size_t id);
 
-	inline bool Triangulate::triangulate(const std::string& source_obj, const std::string& target_obj)
-	{
-		close();
+		void work(size_t id);
 
-		source = fopen(source_obj.c_str(), "rb");
+		bool pop(size_t id, Range& range);
 
-		if( source == nullptr )
-		{
-			std::cout << "Impossible to open obj file for read!" << std::endl;
+		bool steal(size_t id, Range& range);
 
-			return error();
-		}
+		std::vector<std::unique_ptr<Queue>> queue;
+		std::vector<std::thread> thread;
+		std::vector<Worker> worker;
 
-		if( !can_triangulate() ) return error();
+		std::mutex mutex;
+		std::condition_variable wake;
+		std::condition_variable done;
 
-		target = fopen(target_obj.c_str(), "w");
+		const Task* job;
 
-		if( target == nullptr )
-		{
-			std::cout << "Impossible to open obj file for write!" << std::endl;
+		size_t generation;
+		size_t active;
+		bool   stop;
+	};
 
-			return error();
-		}
+	struct Progress
+	{
+		double fraction() const { return total == 0 ? 0.0 : static_cast<double>(bytes) / static_cast<double>(total); }
 
-		if( !write_header(source_obj) ) return error();
-		if( !triangulate() ) return error();
-		if( !write_header(source_obj) ) return error();
+		uint64_t bytes = 0; // Source bytes written to the target so far
+		uint64_t total = 0; // Source file size
+		uint64_t faces = 0; // Faces triangulated so far
 
-		return true;
-	}
+		double seconds = 0.0; // Since the conversion started
 
-	inline void Triangulate::close()
-	{
-		if( source ) fclose(source);
-		if( target ) fclose(target);
+		bool done = false;
+	};
 
-		source = nullptr;
-		target = nullptr;
-	}
+	using ProgressCallback = std::function<void(const Progress&)>;
 
-	inline bool Triangulate::error()
+	class Monitor // Calls tick at a fixed interval from a thread of its own until destroyed
 	{
-		close();
+	public:
 
-		return false;
-	}
+		Monitor(const std::function<void()>& tick, double interval);
 
-	inline bool Triangulate::triangulate()
-	{
-		constexpr int BUFFER_CHAR = 100'000;
+		~Monitor();
 
-		char buff[BUFFER_CHAR] = {0};
+		Monitor(const Monitor&) = delete;
 
-		std::vector<Point> vertex;
+		Monitor(const Monitor&&) = delete;
 
-		while( fgets(buff, sizeof buff, source) )
-		{
-			const char* line = parse(buff, vertex, count);
+		Monitor& operator=(const Monitor&) = delete;
 
-			if( line == nullptr )
-				continue;
+		Monitor& operator=(const Monitor&&) = delete;
 
-			if( fputs(line, target) == EOF )
-				return error();
+	private:
 
-			if( fputc('\n', target) == EOF )
-				return error();
-		}
+		std::mutex mutex;
+		std::condition_variable wake;
 
-		return true;
-	}
+		bool stop;
 
-	inline bool Triangulate::can_triangulate()
+		std::thread thread;
+	};
+
+	class Trace // Chrome trace events, each thread appends to a buffer of its own without locking
 	{
-		Count temp;
+	public:
 
-		constexpr int BUFFER_CHAR = 100'000;
+		using Clock = std::chrono::steady_clock;
 
-		char buff[BUFFER_CHAR] = {0};
+		struct Event
+		{
+			const char* name; // Static text, not copied
 
-		bool vertex(false), polygon(false);
+			Clock::time_point start;
+			Clock::time_point stop;
 
-		const std::vector<Point> _;
+			size_t corners; // SIZE_MAX when the event is not about one polygon
+		};
 
-		while( fgets(buff, sizeof buff, source) )
-		{
-			const char* line = trim(buff);
+		Trace() : session(next()), start(Clock::now()) {}
 
-			if( !polygon && *line == 'f' && *(line + 1) == ' ' )
-			{
-				std::vector<int> indices;
+		Trace(const Trace&) = delete;
 
-				if( !parse(line + 2, indices, _, temp) )
-					indices.clear();
+		Trace(const Trace&&) = delete;
 
-				if( indices.size() > 3 )
-					polygon = true;
-			}
+		Trace& operator=(const Trace&) = delete;
 
-			if( !vertex && *line == 'v' && *(line + 1) == ' ' )
-				vertex = true;
+		Trace& operator=(const Trace&&) = delete;
 
-			if( vertex && polygon )
-				break;
+		void add(const char* name, const Clock::time_point from, const Clock::time_point to, const size_t corners = SIZE_MAX)
+		{
+			buffer().push_back({name, from, to, corners});
 		}
 
-		if( !(vertex && polygon) )
-			return error();
+		// Chrome trace JSON, opens in Perfetto and chrome://tracing. Call when no thread is adding events
 
-		return fseek(source, 0, SEEK_SET) == 0;
-	}
+		bool write(const std::string& file) const;
 
-	inline std::string filename(const std::string& file)
-	{
-		const auto find = file.find_last_of("/\\");
+	private:
 
-		if( find == std::string::npos )
-			return file;
+		static uint64_t next()
+		{
+			static std::atomic<uint64_t> counter{0};
 
-		return file.substr(find + 1);
-	}
+			return ++counter;
+		}
 
-	inline std::string buffer(size_t count)
-	{
-		static const size_t length = std::to_string(SIZE_MAX).length();
+		std::vector<Event>& buffer();
 
-		std::string buffer = std::string(count * length, ' ');
+		const uint64_t session; // Tells the thread local cache in buffer() apart from an earlier trace at the same address
 
-		return buffer;
-	}
+		const Clock::time_point start;
 
-	//-------------------------------------------------------------------------------------------------------
+		std::mutex mutex; // Guards buffers, taken once per thread
+
+		std::vector<std::unique_ptr<std::vector<Event>>> buffers;
+	};
 
-	inline bool strtoi(const char* text, int& i, const char*& end)
+	class Zone // Adds one event for its scope, does nothing (not even read the clock) without a trace
 	{
-		static int v;
+	public:
 
-		static const char* p;
+		Zone(Trace* trace, const char* name, const size_t corners = SIZE_MAX) : trace(trace), name(name), corners(corners)
+		{
+			if( trace != nullptr ) start = Trace::Clock::now();
+		}
 
-		static bool negative;
+		~Zone()
+		{
+			if( trace != nullptr ) trace->add(name, start, Trace::Clock::now(), corners);
+		}
 
-		p = text;
+		Zone(const Zone&) = delete;
 
-		negative = false;
+		Zone& operator=(const Zone&) = delete;
 
-		while( *p == ' ' || *p == '\t' ) p++;
+	private:
 
-		if( *p == '-' )
-		{
-			negative = true;
+		Trace* trace;
 
-			p++;
-		}
-		else if( *p == '+' )
-			p++;
+		const char* name;
 
-		v = 0;
+		size_t corners;
 
-		while( *p >= '0' && *p <= '9' )
-		{
-			v = (v * 10) + (*p - '0');
+		Trace::Clock::time_point start;
+	};
 
-			p++;
-		}
+	struct Point;
 
-		end = p;
+	struct Triangle;
 
-		i = negative ? -v : v;
+	struct Face;
 
-		return text == end ? false : true;
-	}
+	struct Batch;
 
-	inline bool strtof(const char* text, float& d, const char*& end)
+	enum class Output
 	{
-		static float v;
+		Obj, // Text OBJ, the source with its polygons replaced by triangles
+		Stl, // Binary STL, triangles with facet normals
+		Ply  // Binary little endian PLY, the vertices and the triangles
+	};
 
-		static const char* p;
+	enum class Sort
+	{
+		None,     // Faces in source order
+		Material, // Faces of one material together, in the order the materials first appear
+		Group     // As Material, and faces of one group together within a material
+	};
 
-		static int exponent;
+	enum class Io
+	{
+		Stdio, // Buffered fread and fwrite
+		Uring  // io_uring on Linux, reads ahead and writes behind in flight. Stdio elsewhere
+	};
 
-		static float factor;
+	using State = std::array<std::string, 3>; // The o, g and s statements in effect for a face
 
-		static bool negExp;
+	struct Selection // Adaptive triangulation, thresholds in corners that pick the engine for a polygon, 0 = never
+	{
+		size_t cut   = 0;   // Concave polygons up to this size, cutTriangulation (biggest ear first)
+		size_t sweep = 8;   // Monotone polygons from this size, sweepTriangulation
+		size_t grid  = 64;  // Concave polygons from this size, gridTriangulation instead of clipTriangulation
 
-		static bool negative;
+		std::string text() const { return "cut " + std::to_string(cut) + " sweep " + std::to_string(sweep) + " grid " + std::to_string(grid); }
 
-		p = text;
+		bool load(const std::string& file); // Keeps the thresholds the file does not name
 
-		negative = false;
+		bool save(const std::string& file) const;
+	};
 
-		while( *p == ' ' || *p == '\t' ) p++;
+	struct Chunk // Chunked output, the chunk taking triangles
+	{
+		size_t id        = SIZE_MAX; // None yet
+		size_t triangles = 0;
+		size_t written   = SIZE_MAX; // Chunk of the last triangle written
 
-		if( *p == '-' )
-		{
-			negative = true;
+		std::unordered_set<size_t> vertices;
+	};
 
-			p++;
-		}
-		else if( *p == '+' )
-			p++;
+	struct Section // Sorted output, the faces of one material (and group)
+	{
+		std::string material;
+		std::string ending; // Line ending of the first face, for the statements written before the faces
 
-		v = 0.0;
+		size_t first = 0; // State of the first face
+		size_t last  = 0; // State of the last face so far
 
-		while( *p >= '0' && *p <= '9' )
-		{
-			v = v * 10.0f + static_cast<float>(*p - '0');
+		Chunk chunk; // Chunks do not span materials
 
-			p++;
-		}
+		std::vector<std::pair<uint64_t, size_t>> spans; // Offset and size of the faces in the sorted file
+	};
 
-		if( *p == '.' )
-		{
-			p++;
+	constexpr size_t STL_TRIANGLE_BYTES = 50; // Normal, three corners, attribute
+	constexpr size_t PLY_TRIANGLE_BYTES = 13; // Corner count, three vertex indices
 
-			factor = 0.1f;
+	inline void little(std::string& out, const uint32_t value) // Little endian, whatever the host
+	{
+		out += static_cast<char>(value & 0xff);
+		out += static_cast<char>(value >> 8 & 0xff);
+		out += static_cast<char>(value >> 16 & 0xff);
+		out += static_cast<char>(value >> 24 & 0xff);
+	}
 
-			while( *p >= '0' && *p <= '9' )
-			{
-				v += factor * static_cast<float>(*p - '0');
+	inline void little(std::string& out, const uint16_t value)
+	{
+		out += static_cast<char>(value & 0xff);
+		out += static_cast<char>(value >> 8 & 0xff);
+	}
 
-				factor *= 0.1f;
+	inline void little(std::string& out, const float value)
+	{
+		uint32_t bits(0);
 
-				p++;
-			}
-		}
+		memcpy(&bits, &value, sizeof bits);
 
-		if( *p == 'e' || *p == 'E' )
-		{
-			++p;
+		little(out, bits);
+	}
 
-			exponent = 0;
+	class Weld // Spatial hash of the unique vertices, merges a vertex into an earlier one within the tolerance on every axis
+	{
+	public:
 
-			negExp = false;
+		explicit Weld(const Real tolerance) : tolerance(std::max(Real(0), tolerance)) {}
 
-			if( *p == '-' )
-			{
-				negExp = true;
+		bool add(const Point&); // False when the vertex was merged
 
-				p++;
-			}
-			else if( *p == '+' )
-			{
-				p++;
-			}
+		size_t unique() const { return position.size(); }
 
-			while( *p >= '0' && *p <= '9' )
-			{
-				exponent = exponent * 10 + (*p - '0');
+		// Face words and polygon corners of the original vertices relabelled to the unique ones, as absolute indices
 
-				p++;
-			}
+		void relabel(std::map<size_t, std::string>& index_word, std::vector<Point>& polygon) const;
 
-			v *= static_cast<float>(pow(10.0, negExp ? -exponent : exponent));
-		}
+	private:
 
-		end = p;
+		struct Position
+		{
+			Real x, y, z;
+		};
 
-		d = negative ? -v : v;
+		uint64_t cell(double x, double y, double z) const; // Cell coordinates, hashed
 
-		return text == end ? false : true;
-	}
+		const Real tolerance; // Zero welds exactly equal positions
 
-	inline bool strtoword(char* text, std::string& word, char*& end)
-	{
-		static char* p;
-		static char* e;
+		std::unordered_map<uint64_t, size_t> head; // First unique vertex in a cell, chained through next
 
-		p = text;
+		std::vector<Position> position;
+		std::vector<size_t> next;
 
-		while( isspace(*p) ) p++;
+		std::vector<size_t> to; // Unique vertex of every vertex read
+	};
 
-		e = p;
+	class Store // Vertices by number in blocks. Out of core, full blocks go to a temporary file and only the blocks the faces use are kept in memory
+	{
+	public:
 
-		while( !isspace(*e) && !iseol(*e) ) e++;
+		static constexpr size_t BLOCK = 16384; // Vertices per block, a whole number of pages whatever the size of Point
 
-		end = e;
+		Store() = default;
 
-		word = std::string(p, e);
+		~Store() { release(); }
 
-		return text == end || word.empty() ? false : true;
-	}
-	//-------------------------------------------------------------------------------------------------------
+		Store(const Store&) = delete;
 
-	inline bool iseol(const char& c)
-	{
-		return c == '\r' || c == '\n' || c == '\0';
-	}
+		Store& operator=(const Store&) = delete;
 
-	inline bool isspace(const char& c)
-	{
-		return c == ' ' || c == '\t' || c == '\v';
-	}
+		bool reset(size_t budget); // Before a source, a budget of 0 keeps every vertex in memory. False when there is no temporary file
 
-	inline char* trim(char* p)
-	{
-		static char* e;
+		bool append(const std::vector<Point>&); // False when the temporary file can not be written
 
-		if( p == nullptr ) return nullptr;
+		void resize(size_t); // Lazy vertices, in memory only
 
-		while( std::isspace(*p) ) p++;
+		bool pin(const Batch&); // Out of core, the blocks the faces of the batch use are loaded. False when they can not be read
 
-		e = p;
+		Point& operator[](size_t); // Any vertex in memory, out of core the ones of the pinned blocks
 
-		while( *e != '\0' ) e++;
+		const Point& operator[](size_t) const;
 
-		if( e != p ) e--;
+		size_t size() const { return count; }
 
-		while( std::isspace(*e) && e != p ) e--;
+		size_t memory() const { return resident * bytes(); }
 
-		e++;
+		uint64_t spilled() const { return written; } // Bytes in the temporary file
 
-		*e = '\0';
+		uint64_t loads() const { return loaded; } // Blocks read back from the temporary file
 
-		return p;
-	}
+	private:
 
-	//-------------------------------------------------------------------------------------------------------
+		struct Block
+		{
+			Point* data = nullptr; // Nullptr when only in the temporary file
 
-	inline bool parse(const char* line, Point& point, Count& count)
-	{
-		if( !strtof(line, point.x, line) )
-			return false;
+			bool mapped = false;
 
-		if( !strtof(line, point.y, line) )
-			return false;
+			std::list<size_t>::iterator use; // Resident blocks in the temporary file, place in the recent list
+		};
 
-		if( !strtof(line, point.z, line) )
-			return false;
+		static size_t bytes();
 
-		point.i = count.vertices++;
+		bool load(size_t);
 
-		return true;
-	}
+		void evict(size_t);
 
-	inline int listIndex(int index, int listSize)
-	{
-		return index > 0 ? index - 1 : index + listSize;
-	}
+		void trim(size_t incoming, const std::vector<char>* keep); // Evicts the least recently used blocks until the incoming bytes fit the budget
 
-	inline bool parse(const char* line, std::vector<int>& indices, const std::vector<Point>& vertex, Count& count)
-	{
-		static int index, size;
+		void release();
 
-		size = static_cast<int>(vertex.size());
+		size_t budget = 0;
+		size_t count  = 0;
 
-		while( !iseol(*line) )
-		{
-			if( !strtoi(line, index, line) )
-				return false;
+		size_t resident = 0; // Blocks in memory
 
-			index = listIndex(index, size);
+		std::vector<Block> blocks;
 
-			indices.emplace_back(index);
+		std::list<size_t> recent; // Most recently used first, only blocks that can be evicted
 
-			while( !isspace(*line) && !iseol(*line) )
-				line++;
-		}
+		std::vector<char> needed;
 
-		return true;
-	}
+		FILE* file = nullptr;
 
-	char* triangulate(char* line, const std::vector<int>&, std::vector<Point>&, Count&);
+		uint64_t written = 0;
+		uint64_t loaded  = 0;
+	};
 
-	inline char* parse(char* line, std::vector<Point>& vertex, Count& count)
+	class Ring // io_uring: the source read ahead of the batches and the target written behind them, several requests in flight on registered buffers
 	{
-		line = trim(line);
+	public:
 
-		if( *line == 'f' && *(line + 1) == ' ' )
-		{
-			std::vector<int> indices;
+		static constexpr size_t BUFFERS = 4;       // Per direction, the requests in flight
+		static constexpr size_t BYTES   = 1 << 20; // Per buffer
 
-			if( !parse(line + 2, indices, vertex, count) )
-				return nullptr;
+		Ring() = default;
 
-			return triangulate(line, indices, vertex, count);
-		}
+		~Ring() { close(); }
 
-		if( *line == 'v' && *(line + 1) == ' ' )
-		{
-			Point point;
+		Ring(const Ring&) = delete;
 
-			if( !parse(line + 2, point, count) )
-				return nullptr;
+		Ring& operator=(const Ring&) = delete;
 
-			vertex.emplace_back(point);
-		}
+		// The source is read from offset 0 to its size, the target written from the offset on (-1 for none). False when io_uring is not
+		// available (not Linux, or not allowed), the caller stays with stdio
 
-		return line;
-	}
+		bool open(int source, uint64_t size, int target, uint64_t offset);
 
-	std::vector<Triangle> triangulate(std::vector<Point>&);
+		void close();
 
-	inline char* triangulate(char* line, const std::vector<int>& indices, std::vector<Point>& vertex, Count& count)
-	{
-		if( line == nullptr || *line != 'f' )
-			return nullptr;
+		bool reading() const { return ring >= 0 && input >= 0; }
 
-		const auto initialCountOfIndices = indices.size();
+		bool writing() const { return ring >= 0 && output >= 0; }
 
-		if( initialCountOfIndices < 3 )
-			return nullptr;
+		size_t read(char* data, size_t size); // The next bytes of the source, fewer only at its end or on an error
 
-		if( initialCountOfIndices == 3 )
-			count.triangles.first++;
+		bool write(const char* data, size_t size); // Appended to the target, a full buffer is sent off at once
 
-		if( initialCountOfIndices > 3 )
-			count.polygons.first++;
+		bool flush(); // Waits for every write. False when any request failed
 
-		char* lineStart = line;
+		uint64_t reads() const { return readCount; } // Requests completed
+		uint64_t writes() const { return writeCount; }
 
-		line++;
+	private:
 
-		std::string text;
+		struct Buffer
+		{
+			char* data = nullptr;
 
-		std::map<size_t, std::string> index_word;
+			uint64_t offset = 0;
+			size_t   length = 0; // Bytes asked for, 0 when the buffer holds nothing
+			size_t   done   = 0; // Bytes read or written
 
-		const auto size = static_cast<int>(vertex.size());
+			bool busy = false;
+		};
 
-		while( strtoword(line, text, line) )
-		{
-			int index;
+		void submit(size_t buffer); // The rest of the buffer, read or written at its offset
 
-			const char* word = text.c_str();
+		void issue(size_t buffer); // Next block of the source into a read buffer
 
-			if( !strtoi(word, index, word) )
-				return nullptr;
+		void send(); // The buffer being filled to the target
 
-			index = listIndex(index, size);
+		bool wait(); // For at least one completion
 
-			if( index_word.count(index) == 0 )
-				index_word[index] = text;
-		}
+		void complete(size_t buffer, int result);
 
-		if( initialCountOfIndices > 3 )
-			count.polygons.second++;
+		int ring = -1;
 
-		std::vector<Point> polygon;
+		int input  = -1;
+		int output = -1;
 
-		for( const auto& index : indices )
-		{
-			if( index < size )
-				polygon.emplace_back(vertex[index]);
-		}
+		bool fixed  = false; // Buffers registered
+		bool failed = false;
 
-		if( indices.size() < 3 )
-			return nullptr;
-				
-		const std::vector<Triangle> triangles = triangulate(polygon);
+		unsigned* sqHead  = nullptr;
+		unsigned* sqTail  = nullptr;
+		unsigned* sqMask  = nullptr;
+		unsigned* sqArray = nullptr;
+		unsigned* cqHead  = nullptr;
+		unsigned* cqTail  = nullptr;
+		unsigned* cqMask  = nullptr;
 
-		if( triangles.empty() )
-			return nullptr;
+		void*  sq      = nullptr;
+		void*  cq      = nullptr;
+		void*  entries = nullptr; // Submission queue entries
+		void*  events  = nullptr; // Completion queue entries
+		size_t sqBytes = 0;
+		size_t cqBytes = 0;
+		size_t sqeBytes = 0;
 
-		line = lineStart;
+		char* memory = nullptr; // Every buffer, reads first
 
-		for( const auto& triangle : triangles )
-		{
-			*line++ = 'f';
+		Buffer buffers[2 * BUFFERS];
 
-			*line++ = ' ';
-			for( const auto& c : index_word[triangle.p0.i] ) *line++ = c;
+		uint64_t sourceSize = 0;
+		uint64_t nextRead   = 0; // Source offset of the next block asked for
+		size_t   current    = 0; // Read buffer in source order
+		size_t   consumed   = 0; // Bytes of it handed out
 
-			*line++ = ' ';
-			for( const auto& c : index_word[triangle.p1.i] ) *line++ = c;
+		uint64_t nextWrite = 0; // Target offset of the next buffer sent
+		size_t   filling   = 0; // Write buffer being filled
+		size_t   filled    = 0;
 
-			*line++ = ' ';
-			for( const auto& c : index_word[triangle.p2.i] ) *line++ = c;
+		uint64_t readCount  = 0;
+		uint64_t writeCount = 0;
+	};
 
-			*line++ = '\n';
+	class Triangulate
+	{
+	public:
 
-			count.triangles.second++;
-		}
+		explicit Triangulate() : source(nullptr), target(nullptr), threadCount(std::max(1u, std::thread::hardware_concurrency())) {}
 
-		*(--line) = '\0';
+		~Triangulate();
 
-		return lineStart;
-	}
+		Triangulate(const Triangulate&) = delete;
 
-	//-------------------------------------------------------------------------------------------------------
+		Triangulate(const Triangulate&&) = delete;
 
-	enum class TurnDirection
-	{
-		Right  = 1,
-		Left   = -1,
-		NoTurn = 0
-	};
+		Triangulate& operator=(const Triangulate&) = delete;
 
-	inline Point operator-(const Point& u, const Point& v)
-	{
-		return {u.x - v.x , u.y - v.y , u.z - v.z};
-	}
+		Triangulate& operator=(const Triangulate&&) = delete;
 
-	inline Point operator/(const Point& u, const float div)
-	{
-		if( div == 0.0f ) return {0.0f , 0.0f , 0.0f};
+		bool triangulate(const std::string& source_obj, const std::string& target_obj);
 
-		return {u.x / div , u.y / div , u.z / div};
-	}
+		const Count& metrics() const { return count; }
 
-	inline bool operator==(const Point& u, const Point& v)
-	{
-		if( fabs(u.x - v.x) > epsilon ) return false;
-		if( fabs(u.y - v.y) > epsilon ) return false;
-		if( fabs(u.z - v.z) > epsilon ) return false;
+		bool empty() const { return count.empty(); }
 
-		return true;
-	}
+		void threads(const size_t n) { threadCount = std::max<size_t>(1, n); }
 
-	inline Point cross(const Point& u, const Point& v)
-	{
-		return {u.y * v.z - u.z * v.y , u.z * v.x - u.x * v.z , u.x * v.y - u.y * v.x};
-	}
+		const std::vector<Worker>& workers() const { return worker; }
 
-	inline double dot(const Point& u, const Point& v)
-	{
-		return u.x * v.x + u.y * v.y + u.z * v.z;
-	}
+		const Profile& profile() const { return timing; }
 
-	inline float length(const Point& u)
-	{
-		return std::sqrt(u.x * u.x + u.y * u.y + u.z * u.z);
-	}
+		// The callback runs on a monitor thread every interval seconds, and once more on the calling thread when done
 
-	inline Point normalize(const Point& point)
-	{
-		return point / obj::length(point);
-	}
+		void progress(const ProgressCallback& callback, const double interval = 1.0)
+		{
+			progressCallback = callback;
+			progressInterval = interval;
+		}
 
-	inline TurnDirection turn(const Point& p, const Point& u, const Point& n, const Point& q)
-	{
-		const auto v = cross(q - p, u);
+		// Timeline of the conversion phases, the tasks and every large polygon. Nullptr (the default) turns tracing off
 
-		const auto dot = obj::dot(v, n);
+		void trace(Trace* events) { tracer = events; }
 
-		if( dot > +0.001 ) return TurnDirection::Right;
-		if( dot < -0.001 ) return TurnDirection::Left;
+		// Skip the conversion when the target header holds the hash of this source and these settings
 
-		return TurnDirection::NoTurn;
-	}
+		void incremental(const bool on) { skipUnchanged = on; }
 
-	inline float triangleAreaSquared(const Point& a, const Point& b, const Point& c)
-	{
-		const auto cross = obj::cross(b - a, c - a);
+		bool skipped() const { return unchanged; }
 
-		return (cross.x * cross.x + cross.y * cross.y + cross.z * cross.z) / 4.0f;
-	}
+		// Vertices are only located while reading, and decoded when a polygon first uses them. Pays off when most faces are triangles
 
-	//-------------------------------------------------------------------------------------------------------
+		void lazy(const bool on) { lazyVertices = on; }
 
-	inline Point normal(const std::vector<Point>& polygon) //Newell's method
-	{
-		Point normal;
+		// Vertices past this many bytes of memory go to a temporary file, the blocks a batch uses are read back (least recently used go first).
+		// 0 (the default) keeps every vertex in memory. Lazy vertices are not used out of core
 
-		const auto n = polygon.size();
+		void budget(const size_t bytes) { memoryBudget = bytes; }
 
-		if( n < 3 ) return normal;
+		// Vertices within the tolerance of an earlier one are dropped and faces renumbered to the unique vertices
 
-		for( size_t index = 0; index < n; index++ )
+		void weld(const bool on, const Real tolerance = epsilon)
 		{
-			const Point& item = polygon[index % n];
-			const Point& next = polygon[(index + 1) % n];
-
-			normal.x += (next.y - item.y) * (next.z + item.z);
-			normal.y += (next.z - item.z) * (next.x + item.x);
-			normal.z += (next.x - item.x) * (next.y + item.y);
+			welding       = on;
+			weldTolerance = tolerance;
 		}
 
-		return normalize(normal);
-	}
+		void output(const Output format) { outputFormat = format; }
 
-	inline bool convex(const std::vector<Point>& polygon, const Point& normal)
-	{
-		const auto n = polygon.size();
+		// Faces grouped by material (and group) to cut the material switches, OBJ output only. Faces are written after every other line
 
-		if( n < 3 ) return false;
+		void sort(const Sort order) { ordering = order; }
 
-		if( n == 3 ) return true;
+		// Triangles split into chunks of at most this many vertices (and triangles, 0 = any), for 16-bit indices or meshlets. 0 turns it off
 
-		auto polygonTurn = TurnDirection::NoTurn;
+		void chunk(const size_t vertices, const size_t triangles = 0)
+		{
+			chunkVertices  = vertices == 0 ? 0 : std::max<size_t>(3, vertices);
+			chunkTriangles = triangles;
+		}
 
-		for( size_t index = 0; index < n; index++ )
+		// Engine picked per polygon from its size and shape (small-n kernels, fan, sweep, ear clipping with or without a grid)
+
+		void adapt(const bool on, const Selection& thresholds = Selection())
 		{
-			const auto& prev = polygon[(index - 1 + n) % n];
-			const auto& item = polygon[index % n];
-			const auto& next = polygon[(index + 1) % n];
+			adaptive  = on;
+			selection = thresholds;
+		}
 
-			const auto u = normalize(item - prev);
+		// Polygons with at least this many corners are split on diagonals into pieces that are triangulated on every thread, with the
+		// adaptive engines (the thresholds of adapt()). 0 (the default) turns it off
 
-			const auto itemTurn = turn(prev, u, normal, next);
+		void split(const size_t corners) { splitCorners = corners; }
 
-			if( itemTurn == TurnDirection::NoTurn )
-				continue;
+		// Every batch is sized first, then copied by the workers into the mapped target at the offsets of the bytes before it. The target
+		// is allocated ahead of the batches. OBJ without sort and chunks, and STL. Other targets (and Windows) are written through stdio
 
-			if( polygonTurn == TurnDirection::NoTurn )
-				polygonTurn = itemTurn;
+		void map(const bool on) { mappedOutput = on; }
 
-			if( polygonTurn != itemTurn )
-				return false;
-		}
+		// Source and target through io_uring (Linux): reads of the next blocks and writes of the last ones in flight while a batch is
+		// triangulated. Stdio where io_uring is not available. A mapped target is still written by the workers
 
-		return true;
-	}
+		void io(const Io backend) { ioBackend = backend; }
 
-	inline bool clockwiseOriented(const std::vector<Point>& polygon, const Point& normal)
-	{
-		const auto n = polygon.size();
+	private:
 
-		if( n < 3 ) return false;
+		Progress snapshot() const;
 
-		double orientationSum(0.0);
+		Count count;
 
-		for( size_t index = 0; index < n; index++ )
-		{
-			const auto& prev = polygon[(index - 1 + n) % n];
-			const auto& item = polygon[index % n];
-			const auto& next = polygon[(index + 1) % n];
+		Profile timing;
 
-			const auto& edge        = item - prev;
-			const auto& toNextPoint = next - item;
+		bool triangulate();
 
-			const auto cross = obj::cross(edge, toNextPoint);
+		bool read(Batch&);
 
-			orientationSum += dot(cross, normal);
-		}
+		void decode(Batch&, size_t, std::vector<Point>&);
 
-		return orientationSum < 0.0;
-	}
+		bool resolve(const Batch&, Store&);
 
-	inline void makeClockwiseOrientation(std::vector<Point>& polygon, const Point& normal)
-	{
-		if( polygon.size() < 3 ) return;
+		void run(Batch&, const Store&, Scheduler&);
 
-		if( !clockwiseOriented(polygon, normal) )
-			polygon = {polygon.rbegin() , polygon.rend()};
-	}
+		std::vector<Triangle> divide(std::vector<Point>&, Scheduler&);
 
-	inline bool pointInsideOrEdgeTriangle(const Point& a, const Point& b, const Point& c, const Point& p, bool& edge)
-	{
-		static double zero = std::numeric_limits<double>::epsilon();
+		bool write(const Batch&);
 
-		// Initialize edge to false
-		edge = false;
+		bool place(const Batch&, Scheduler&);
 
-		// Vectors from point p to vertices of the triangle
-		const auto v0 = c - a;
-		const auto v1 = b - a;
-		const auto v2 = p - a;
+		bool put(const char* data, const size_t size) // To the target after the header
+		{
+			return ring.writing() ? ring.write(data, size) : fwrite(data, 1, size, target) == size;
+		}
 
-		const auto dot00 = dot(v0, v0);
-		const auto dot01 = dot(v0, v1);
-		const auto dot02 = dot(v0, v2);
-		const auto dot11 = dot(v1, v1);
-		const auto dot12 = dot(v1, v2);
+		bool append();
 
-		// Check for degenerate triangle
-		const auto denom = dot00 * dot11 - dot01 * dot01;
+		bool sorting() const { return ordering != Sort::None && outputFormat == Output::Obj; }
 
-		if( std::abs(denom) < zero )
+		bool chunking() const { return chunkVertices > 0; }
+
+		bool mapping() const
 		{
-			// The triangle is degenerate (i.e., has no area)
+#ifdef _WIN32
 			return false;
+#else
+			return mappedOutput && (outputFormat == Output::Stl || (outputFormat == Output::Obj && !sorting() && !chunking()));
+#endif
 		}
 
-		// Compute barycentric coordinates
-		const auto invDenom = 1.0 / denom;
+		bool verbatim() const { return welder == nullptr && outputFormat == Output::Obj && !sorting() && !chunking(); } // Triangles written as they are
 
-		const auto u = (dot11 * dot02 - dot01 * dot12) * invDenom;
-		const auto v = (dot00 * dot12 - dot01 * dot02) * invDenom;
+		void group(Batch&);
 
-		// Check for edge condition
-		if( std::abs(u) < zero || std::abs(v) < zero || std::abs(u + v - 1) < zero )
-			edge = true;
+		void cluster(Batch&, const std::vector<size_t>&, Chunk&);
 
-		// Check if point is inside the triangle (including edges)
-		return (u >= 0.0) && (v >= 0.0) && (u + v < 1.0);
-	}
+		size_t section(const std::string& material, size_t state);
 
-	inline void removeConsecutiveEqualItems(std::vector<Point>& list)
-	{
-		const auto n = list.size();
+		bool can_triangulate();
 
-		const std::vector copy(std::move(list));
+		bool write_header(const std::string&);
+
+		bool fits() const // Binary STL counts and PLY indices are 32 bit, a larger model would wrap
+		{
+			if( writtenVertices <= UINT32_MAX && writtenTriangles <= UINT32_MAX ) return true;
+
+			std::cout << "Error: More than 2^32 vertices or triangles do not fit binary STL or PLY, write OBJ instead!" << std::endl;
+
+			return false;
+		}
+
+		bool uptodate(const std::string&, const std::string&) const;
+
+		uint64_t hash() const;
+
+		std::string settings() const // Everything besides the source that changes the target
+		{
+			std::string text = "format 1";
+
+			if( outputFormat == Output::Stl ) text += " stl";
+			if( outputFormat == Output::Ply ) text += " ply";
+
+			if( welding ) text += " weld " + std::to_string(weldTolerance);
+
+			if( ordering == Sort::Material ) text += " sort material";
+			if( ordering == Sort::Group ) text += " sort group";
+
+			if( chunking() ) text += " chunk " + std::to_string(chunkVertices) + ":" + std::to_string(chunkTriangles);
+
+			if( adaptive ) text += " adaptive " + selection.text();
+
+			if( splitCorners != 0 ) text += " split " + std::to_string(splitCorners);
+
+			if( sizeof(Real) != sizeof(float) ) text += " double";
+
+			return text;
+		}
+
+		void close();
+
+		bool error();
+
+		FILE* source;
+		FILE* target;
+
+		size_t threadCount;
+
+		std::vector<Worker> worker;
+
+		ProgressCallback progressCallback;
+
+		double progressInterval = 1.0;
+
+		std::chrono::steady_clock::time_point progressStart;
+
+		uint64_t progressTotal = 0;
+
+		std::atomic<uint64_t> progressBytes{0};
+		std::atomic<uint64_t> progressFaces{0};
+
+		Trace* tracer = nullptr;
+
+		Hash contents; // Source bytes read so far
+
+		bool skipUnchanged = false;
+		bool unchanged     = false;
+
+		bool lazyVertices = false;
+
+		bool welding = false;
+
+		Real weldTolerance = epsilon;
+
+		std::unique_ptr<Weld> welder; // Only while welding
+
+		Output outputFormat = Output::Obj;
+
+		FILE* faces = nullptr; // Binary PLY, the triangles wait here until every vertex is written
+
+		uint64_t writtenVertices  = 0; // Binary STL and PLY
+		uint64_t writtenTriangles = 0;
+
+		Sort ordering = Sort::None;
+
+		FILE* sorted = nullptr; // Sorted output, the faces wait here in spans until every other line is written
+
+		uint64_t sortedBytes = 0;
+
+		std::vector<Section> sections;
+
+		std::unordered_map<std::string, size_t> sectionIndex; // Material, and the o and g statements when sorted by group
+
+		std::vector<State> states;
+
+		std::string material; // In effect while decoding
+
+		size_t textures = 0; // vt and vn lines so far, resolve relative indices of faces that are moved
+		size_t normals  = 0;
+
+		std::vector<std::string> pending; // Faces of the batch, per section
+
+		bool unterminated = false; // The last line written has no line ending
+
+		size_t chunkVertices  = 0;
+		size_t chunkTriangles = 0;
+
+		Chunk stream; // Chunked output, the chunk taking triangles when the output is not sorted
+
+		std::vector<bool> referenced; // Vertices in any chunk
+
+		FILE* lookup = nullptr; // Second handle on the source, for vertices of earlier batches
+
+		std::vector<uint64_t> located; // Source offset of the coordinates of every vertex, decoded ones are set to UINT64_MAX
+
+		bool adaptive = false;
+
+		Selection selection;
+
+		size_t splitCorners = 0;
+
+		bool mappedOutput = false;
+
+		uint64_t mappedEnd      = 0; // Mapped output, end of the bytes written
+		uint64_t mappedReserved = 0; // Mapped output, end of the space allocated
+
+		Io ioBackend = Io::Stdio;
+
+		Ring ring; // Open during a conversion with Io::Uring
+
+		std::unique_ptr<Scheduler> pool; // Kept between conversions, only the first one starts the threads
+
+		std::unique_ptr<Batch> reused; // Kept between conversions with the vertex stores, so their capacity is reused
+
+		size_t memoryBudget = 0;
+
+		Store stored;
+
+		std::vector<Point> decoded;
+	};
+
+	//-------------------------------------------------------------------------------------------------------
+
+	struct Point
+	{
+		Point() : i(0), x(0), y(0), z(0) {}
+
+		Point(const Real& x, const Real& y, const Real& z) : i(0), x(x), y(y), z(z) {}
+
+		Vertex i;
+		Real   x;
+		Real   y;
+		Real   z;
+	};
+
+	struct Triangle
+	{
+		Triangle(const Point& p0, const Point& p1, const Point& p2) : p0(p0), p1(p1), p2(p2) {}
+
+		Point p0, p1, p2;
+	};
+
+	struct Face
+	{
+		size_t offset   = 0; // Start of the face statement in the batch text
+		size_t vertices = 0; // Vertex count when the face was read, resolves relative indices
+		size_t textures = 0; // Sorted output, vt and vn counts when the face was read
+		size_t normals  = 0;
+		size_t section  = 0; // Sorted output
+		size_t state    = 0;
+
+		std::vector<Index> indices;
+
+		std::string text; // Triangulated face, empty when the face is dropped
+
+		std::vector<size_t> corners; // Chunked output, the vertex of every triangle corner
+		std::vector<size_t> chunks;  // Chunked output, the chunk of every triangle
+
+		Count count;
+
+		double triangulation = 0.0;
+		double format        = 0.0;
+	};
+
+	struct Batch
+	{
+		static constexpr size_t none = SIZE_MAX;
+		static constexpr size_t skip = SIZE_MAX - 1; // Line is dropped from the output
+
+		struct Line
+		{
+			size_t offset;
+			size_t length; // Including the line ending
+			size_t face;
+		};
+
+		void reset() // Before another source, keeps the capacity
+		{
+			text.clear();
+
+			position = 0;
+
+			clear();
+		}
+
+		void clear() // Keeps the start of the next line, read with the last block
+		{
+			text.erase(0, bytes);
+
+			position += bytes;
+
+			bytes = 0;
+
+			lines.clear();
+			faces.clear();
+
+			vertices.clear();
+		}
+
+		size_t bytes = 0; // Source bytes in the batch lines
+
+		uint64_t position = 0; // Source offset of the text
+
+		size_t memory() const
+		{
+			size_t bytes = text.capacity() + lines.capacity() * sizeof(Line) + faces.capacity() * sizeof(Face);
+
+			for( const auto& face : faces )
+				bytes += face.indices.capacity() * sizeof(Index) + face.text.capacity() + (face.corners.capacity() + face.chunks.capacity()) * sizeof(size_t);
+
+			return bytes;
+		}
+
+		std::string text; // Source bytes as read, never modified, so untouched lines are written as they came
+
+		std::vector<Line> lines;
+		std::vector<Face> faces;
+
+		std::vector<Point> vertices; // Binary PLY, the vertices to write with the batch
+	};
+
+	inline const char* ending(const Batch& batch, const Batch::Line& line) // Line ending of a source line, kept for its triangles
+	{
+		const char* eol = batch.text.data() + line.offset + line.length;
+
+		if( line.length >= 2 && *(eol - 2) == '\r' && *(eol - 1) == '\n' ) return "\r\n";
+
+		return line.length >= 1 && *(eol - 1) == '\n' ? "\n" : "";
+	}
+
+	inline const char* separator(const Batch& batch, const Batch::Line& line) // Between the triangles of a face, the ending of the face or of the first line
+	{
+		const auto* last = ending(batch, line);
+
+		return *last != '\0' ? last : batch.lines.size() > 1 && *ending(batch, batch.lines.front()) != '\0' ? ending(batch, batch.lines.front()) : "\n";
+	}
+
+	//-------------------------------------------------------------------------------------------------------
+
+	char* trim(char*);
+
+	bool iseol(const char&);
+
+	bool isspace(const char&);
+
+	bool skim(const char*, const char*&);
+
+	size_t words(const char*, size_t);
+
+	bool indexed(const char*, size_t);
+
+	std::string statement(const char*);
+
+	bool parse(const char*, Point&, Count&);
+
+	char* parse(char* line, std::vector<Point>&, Count&);
+
+	bool parse(const char*, std::vector<Index>&, const std::vector<Point>&, Count&);
+
+	bool parse(const char*, std::vector<Index>&, size_t);
+
+	template<typename Vertices> bool gather(const char*, const std::vector<Index>&, const Vertices&, size_t, Count&, std::map<size_t, std::string>&, std::vector<Point>&);
+
+	bool format(const std::vector<Triangle>&, std::map<size_t, std::string>&, Count&, std::string&);
+
+	bool encode(const std::vector<Triangle>&, Output, Count&, std::string&);
+
+	void absolute(std::map<size_t, std::string>&, size_t, size_t);
+
+	void transition(const State&, const State&, const char*, std::string&);
+
+	std::vector<Triangle> triangulate(std::vector<Point>&);
+
+	std::vector<Triangle> triangulate(std::vector<Point>&, const Selection&);
+
+	void removeConsecutiveEqualItems(std::vector<Point>&);
+
+	Point normal(const std::vector<Point>&);
+
+	bool halve(const std::vector<Point>&, const Point&, std::vector<Point>&, std::vector<Point>&);
+
+	//-------------------------------------------------------------------------------------------------------
+
+	inline Triangulate::~Triangulate() { close(); }
+
+	inline bool Triangulate::triangulate(const std::string& source_obj, const std::string& target_obj)
+	{
+		close();
+
+		count  = Count();
+		timing = Profile();
+
+		contents  = Hash();
+		unchanged = skipUnchanged && uptodate(source_obj, target_obj);
+
+		if( unchanged ) return true;
+
+		source = fopen(source_obj.c_str(), "rb");
+
+		if( source == nullptr )
+		{
+			std::cout << "Impossible to open obj file for read!" << std::endl;
+
+			return error();
+		}
+
+		progressStart = std::chrono::steady_clock::now();
+
+		progressTotal = 0;
+		progressBytes = 0;
+		progressFaces = 0;
+
+		if( seek(source, 0, SEEK_END) == 0 )
+		{
+			const auto size = tell(source);
+
+			progressTotal = size != UINT64_MAX ? size : 0;
+		}
+
+		if( seek(source, 0) != 0 ) return error();
+
+		const auto prescan = std::chrono::steady_clock::now();
+
+		if( !can_triangulate() ) return error();
+
+		const auto scanned = std::chrono::steady_clock::now();
+
+		timing.seconds[Profile::Prescan] += std::chrono::duration<double>(scanned - prescan).count();
+
+		if( tracer != nullptr ) tracer->add(Profile::name(Profile::Prescan), prescan, scanned);
+
+		target = fopen(target_obj.c_str(), mapping() ? "w+b" : "wb"); // Binary, untouched lines keep their line endings. Shared mappings need read access
+
+		if( target == nullptr )
+		{
+			std::cout << "Impossible to open obj file for write!" << std::endl;
+
+			return error();
+		}
+
+		if( lazyVertices && memoryBudget == 0 && !welding && outputFormat != Output::Ply && (lookup = fopen(source_obj.c_str(), "rb")) == nullptr ) return error();
+
+		writtenVertices  = 0;
+		writtenTriangles = 0;
+
+		if( outputFormat == Output::Ply && (faces = tmpfile()) == nullptr ) return error();
+
+		sortedBytes  = 0;
+		unterminated = false;
+
+		stream = Chunk();
+
+		referenced.clear();
+
+		sections.clear();
+		sectionIndex.clear();
+
+		pending.clear();
+
+		states.assign(1, State());
+
+		material.clear();
+
+		textures = 0;
+		normals  = 0;
+
+		if( sorting() && (sorted = tmpfile()) == nullptr ) return error();
+
+		if( outputFormat != Output::Obj )
+			setvbuf(target, nullptr, _IOFBF, 4 << 20);
+
+		welder = welding ? std::make_unique<Weld>(weldTolerance) : nullptr;
+
+		if( !write_header(source_obj) ) return error();
+
+		if( mapping() ) // The batches follow the header, which keeps its size when rewritten
+		{
+			if( fflush(target) != 0 || (mappedEnd = tell(target)) == UINT64_MAX ) return error();
+
+			mappedReserved = mappedEnd;
+		}
+
+#ifdef __linux__
+		if( ioBackend == Io::Uring && progressTotal > 0 ) // Stays with stdio when the ring can not be set up
+		{
+			const auto writes = !mapping();
+
+			if( writes && fflush(target) != 0 ) return error();
+
+			ring.open(fileno(source), progressTotal, writes ? fileno(target) : -1, writes ? tell(target) : 0);
+		}
+#endif
+
+		if( !triangulate() ) return error();
+		if( !append() ) return error();
+		if( !ring.flush() ) return error();
+
+		timing.ringReads  = ring.reads();
+		timing.ringWrites = ring.writes();
+
+		ring.close();
+
+		if( !write_header(source_obj) ) return error();
+
+		close(); // Flushes the final header, an incremental run trusts its hash
+
+		return true;
+	}
+
+	inline void Triangulate::close()
+	{
+		ring.close(); // Before the files, requests may be in flight
+
+		if( source ) fclose(source);
+		if( target ) fclose(target);
+		if( lookup ) fclose(lookup);
+		if( faces ) fclose(faces);
+		if( sorted ) fclose(sorted);
+
+		source = nullptr;
+		target = nullptr;
+		lookup = nullptr;
+		faces  = nullptr;
+		sorted = nullptr;
+
+		located.clear();
+	}
+
+	inline bool Triangulate::error()
+	{
+		close();
+
+		return false;
+	}
+
+	bool readline(FILE*, std::string&);
+
+	bool triangulate(const char*, const std::vector<Index>&, const std::vector<Point>&, size_t, Count&, std::string&);
+
+	inline bool Triangulate::triangulate()
+	{
+		using Clock = std::chrono::steady_clock;
+
+		if( pool == nullptr || pool->workers().size() != threadCount )
+			pool = std::make_unique<Scheduler>(threadCount);
+
+		if( reused == nullptr )
+			reused = std::make_unique<Batch>();
+
+		Scheduler& scheduler = *pool;
+
+		scheduler.reset();
+
+		auto& vertex = stored;
+		auto& points = decoded;
+
+		auto& batch = *reused;
+
+		points.clear();
+
+		batch.reset();
+
+		if( !vertex.reset(memoryBudget) ) return error();
+
+		std::unique_ptr<Monitor> monitor;
+
+		if( progressCallback )
+			monitor = std::make_unique<Monitor>([this] { progressCallback(snapshot()); }, progressInterval);
+
+		auto time = Clock::now();
+
+		const auto lap = [&](const Profile::Phase phase)
+		{
+			const auto now = Clock::now();
+
+			timing.seconds[phase] += std::chrono::duration<double>(now - time).count();
+
+			if( tracer != nullptr ) tracer->add(Profile::name(phase), time, now);
+
+			time = now;
+		};
+
+		while( read(batch) )
+		{
+			lap(Profile::Read);
+
+			decode(batch, vertex.size(), points);
+
+			lap(Profile::Parse);
+
+			if( !vertex.append(points) || !vertex.pin(batch) )
+				return error();
+
+			if( lookup != nullptr )
+			{
+				vertex.resize(located.size());
+
+				if( !resolve(batch, vertex) )
+					return error();
+			}
+
+			lap(Profile::Store);
+
+			{
+				Zone zone(tracer, Profile::name(Profile::Triangulation));
+
+				run(batch, vertex, scheduler);
+			}
+
+			time = Clock::now();
+
+			if( chunking() )
+				group(batch);
+
+			if( !(mapping() ? place(batch, scheduler) : write(batch)) )
+				return error();
+
+			lap(Profile::Write);
+
+			timing.vertexBytes = std::max(timing.vertexBytes, vertex.memory() + located.capacity() * sizeof(uint64_t));
+			timing.batchBytes  = std::max(timing.batchBytes, batch.memory());
+
+			progressBytes.fetch_add(batch.bytes, std::memory_order_relaxed);
+		}
+
+		worker = scheduler.workers();
+
+#ifndef _WIN32
+		if( mapping() && ftruncate(fileno(target), static_cast<off_t>(mappedEnd)) != 0 ) // Drops the space allocated ahead
+			return error();
+#endif
+
+		timing.vertexFileBytes = vertex.spilled();
+		timing.vertexLoads     = vertex.loads();
+
+		monitor.reset();
+
+		if( progressCallback )
+		{
+			auto last = snapshot();
+
+			last.done = true;
+
+			progressCallback(last);
+		}
+
+		return true;
+	}
+
+	inline Progress Triangulate::snapshot() const
+	{
+		Progress progress;
+
+		progress.bytes   = progressBytes.load(std::memory_order_relaxed);
+		progress.faces   = progressFaces.load(std::memory_order_relaxed);
+		progress.total   = progressTotal;
+		progress.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - progressStart).count();
+
+		return progress;
+	}
+
+	inline bool Triangulate::read(Batch& batch)
+	{
+		constexpr size_t BATCH_BYTES = 4 << 20;
+
+		batch.clear();
+
+		auto& text = batch.text;
+
+		size_t begin(0), scan(text.size());
+
+		bool end(false);
+
+		while( batch.lines.empty() && !end ) // More than one block only for a line longer than a block
+		{
+			const auto kept = text.size();
+
+			text.resize(kept + BATCH_BYTES);
+
+			const auto size = ring.reading() ? ring.read(&text[kept], BATCH_BYTES) : fread(&text[kept], 1, BATCH_BYTES, source);
+
+			text.resize(kept + size);
+
+			if( skipUnchanged ) contents.add(text.data() + kept, size); // Only incremental runs compare the hash, the others write 0
+
+			end = size < BATCH_BYTES;
+
+			while( const auto* eol = static_cast<const char*>(memchr(text.data() + scan, '\n', text.size() - scan)) )
+			{
+				scan = static_cast<size_t>(eol - text.data()) + 1;
+
+				batch.lines.push_back({begin, scan - begin, Batch::none});
+
+				begin = scan;
+			}
+
+			scan = text.size();
+		}
+
+		if( end && begin < text.size() ) // Last line without a line ending
+		{
+			batch.lines.push_back({begin, text.size() - begin, Batch::none});
+
+			begin = text.size();
+		}
+
+		batch.bytes = begin;
+
+		return !batch.lines.empty();
+	}
+
+	inline void Triangulate::decode(Batch& batch, const size_t vertices, std::vector<Point>& points)
+	{
+		points.clear();
+
+		size_t triangles(0), added(0);
+
+		for( size_t index = 0; index < batch.lines.size(); index++ )
+		{
+			auto& item = batch.lines[index];
+
+			const char* line = batch.text.data() + item.offset;
+
+			while( isspace(*line) ) line++;
+
+			if( *line == 'f' && *(line + 1) == ' ' )
+			{
+				const auto corners = words(line + 2, 4);
+
+				if( corners == 3 && verbatim() && indexed(line + 2, vertices + added) ) // Triangles are written as they are, only polygons are parsed
+				{
+					count.triangles.first++;
+					count.triangles.second++; // As if written by format
+
+					triangles++;
+
+					continue;
+				}
+
+				std::vector<Index> indices;
+
+				if( corners < 3 || !parse(line + 2, indices, vertices + added) )
+				{
+					item.face = Batch::skip;
+
+					continue;
+				}
+
+				item.face = batch.faces.size();
+
+				batch.faces.emplace_back();
+				batch.faces.back().offset   = static_cast<size_t>(line - batch.text.data());
+				batch.faces.back().vertices = vertices + added;
+				batch.faces.back().indices  = std::move(indices);
+
+				if( !sorting() ) continue;
+
+				auto& face = batch.faces.back();
+
+				face.textures = textures;
+				face.normals  = normals;
+				face.state    = states.size() - 1;
+				face.section  = section(material, face.state);
+			}
+			else if( *line == 'v' && *(line + 1) == ' ' )
+			{
+				if( lookup != nullptr )
+				{
+					const char* at = line + 2;
+
+					if( !skim(at, at) || !skim(at, at) || !skim(at, at) ) // Dropped as parse() drops it
+					{
+						item.face = Batch::skip;
+
+						continue;
+					}
+
+					located.push_back(batch.position + static_cast<uint64_t>(line + 2 - batch.text.data()));
+
+					count.vertices++;
+					added++;
+
+					continue;
+				}
+
+				Point point;
+
+				if( !parse(line + 2, point, count) )
+				{
+					item.face = Batch::skip;
+
+					continue;
+				}
+
+				points.emplace_back(point);
+
+				added++;
+
+				if( welder != nullptr && !welder->add(point) )
+				{
+					item.face = Batch::skip;
+
+					count.welded++;
+
+					continue;
+				}
+
+				if( outputFormat == Output::Ply )
+					batch.vertices.emplace_back(point);
+			}
+			else if( *line == 'u' && strncmp(line, "usemtl", 6) == 0 && (isspace(line[6]) || iseol(line[6])) )
+			{
+				auto name = statement(line + 6);
+
+				if( name != material )
+				{
+					count.materials.first++;
+
+					if( !sorting() ) count.materials.second++; // Written as it is
+				}
+
+				material = std::move(name);
+
+				if( sorting() ) item.face = Batch::skip; // Written before the faces of its section
+			}
+			else if( sorting() )
+			{
+				if( *line == 'v' && *(line + 1) == 't' && isspace(*(line + 2)) )
+					textures++;
+				else if( *line == 'v' && *(line + 1) == 'n' && isspace(*(line + 2)) )
+					normals++;
+				else if( (*line == 'o' || *line == 'g' || *line == 's') && (isspace(*(line + 1)) || iseol(*(line + 1))) )
+				{
+					auto state = states.back();
+
+					state[*line == 'o' ? 0 : *line == 'g' ? 1 : 2] = statement(line);
+
+					states.push_back(std::move(state));
+
+					item.face = Batch::skip; // Written with the faces, where the state changes
+				}
+			}
+		}
+
+		timing.histogram.front().faces += triangles;
+
+		progressFaces.fetch_add(triangles, std::memory_order_relaxed);
+	}
+
+	inline bool Triangulate::resolve(const Batch& batch, Store& vertex)
+	{
+		constexpr size_t LINE_BYTES = 1024;    // Read behind a vertex offset, more than the coordinates of any sane v line
+		constexpr size_t SPAN_BYTES = 1 << 20; // Vertices of earlier batches this close are read at once
+
+		std::vector<size_t> missing;
+
+		for( const auto& face : batch.faces )
+		{
+			for( const auto index : face.indices )
+			{
+				if( index >= 0 && static_cast<size_t>(index) < vertex.size() && located[index] != UINT64_MAX )
+					missing.push_back(static_cast<size_t>(index));
+			}
+		}
+
+		std::sort(missing.begin(), missing.end());
+
+		missing.erase(std::unique(missing.begin(), missing.end()), missing.end());
+
+		Count unused;
+
+		const auto decode = [&](const size_t index, const char* text)
+		{
+			if( !parse(text, vertex[index], unused) )
+				vertex[index] = Point();
+
+			vertex[index].i = static_cast<Vertex>(index);
+
+			located[index] = UINT64_MAX;
+		};
+
+		std::string span;
+
+		for( size_t first = 0, last = 0; first < missing.size(); first = last )
+		{
+			const auto offset = located[missing[first]];
+
+			if( offset >= batch.position ) // Within this batch
+			{
+				decode(missing[first], batch.text.data() + (offset - batch.position));
+
+				last = first + 1;
+
+				continue;
+			}
+
+			last = first + 1;
+
+			while( last < missing.size() && located[missing[last]] < batch.position && located[missing[last]] + LINE_BYTES - offset <= SPAN_BYTES )
+				last++;
+
+			span.resize(static_cast<size_t>(located[missing[last - 1]] - offset) + LINE_BYTES);
+
+			if( seek(lookup, offset) != 0 )
+				return false;
+
+			span.resize(fread(&span[0], 1, span.size(), lookup));
+
+			for( auto index = first; index < last; index++ )
+			{
+				const auto at = static_cast<size_t>(located[missing[index]] - offset);
+
+				decode(missing[index], at < span.size() ? span.data() + at : "");
+			}
+		}
+
+		return true;
+	}
+
+	inline void Triangulate::run(Batch& batch, const Store& vertex, Scheduler& scheduler)
+	{
+		constexpr size_t TASK_GRAIN = 4096; // Polygon corners batched into one task
+		constexpr size_t TASK_LARGE = 256;  // Polygons with at least this many corners get a task of their own
+
+		const auto divided = [&](const size_t index) { return splitCorners != 0 && batch.faces[index].indices.size() >= splitCorners; };
+
+		std::vector<Scheduler::Range> ranges;
+
+		size_t begin(0), cost(0);
+
+		for( size_t index = 0; index < batch.faces.size(); index++ )
+		{
+			const auto n = batch.faces[index].indices.size();
+
+			if( n >= TASK_LARGE || divided(index) )
+			{
+				if( begin < index )
+					ranges.emplace_back(begin, index);
+
+				if( !divided(index) ) // Divided polygons are done after the others, with every thread
+					ranges.emplace_back(index, index + 1);
+
+				begin = index + 1;
+				cost  = 0;
+
+				continue;
+			}
+
+			cost += n;
+
+			if( cost < TASK_GRAIN )
+				continue;
+
+			ranges.emplace_back(begin, index + 1);
+
+			begin = index + 1;
+			cost  = 0;
+		}
+
+		if( begin < batch.faces.size() )
+			ranges.emplace_back(begin, batch.faces.size());
+
+		const auto convert = [&](const size_t index, std::map<size_t, std::string>& index_word, std::vector<Point>& polygon)
+		{
+			using Clock = std::chrono::steady_clock;
+
+			Face& face = batch.faces[index];
+
+			face.text.clear();
+
+			const auto t0 = Clock::now();
+
+			if( !gather(batch.text.data() + face.offset, face.indices, vertex, face.vertices, face.count, index_word, polygon) )
+				return;
+
+			if( welder != nullptr )
+				welder->relabel(index_word, polygon);
+
+			if( sorting() )
+				absolute(index_word, face.textures, face.normals);
+
+			const auto t1 = Clock::now();
+
+			const auto triangles = divided(index) ? divide(polygon, scheduler) : adaptive ? obj::triangulate(polygon, selection) : obj::triangulate(polygon);
+
+			const auto t2 = Clock::now();
+
+			if( tracer != nullptr && face.indices.size() >= TASK_LARGE )
+				tracer->add("Polygon", t1, t2, face.indices.size());
+
+			if( outputFormat == Output::Obj )
+				format(triangles, index_word, face.count, face.text);
+			else
+				encode(triangles, outputFormat, face.count, face.text);
+
+			face.corners.clear();
+
+			if( chunking() )
+			{
+				for( const auto& triangle : triangles )
+					face.corners.insert(face.corners.end(), {triangle.p0.i, triangle.p1.i, triangle.p2.i});
+			}
+
+			const auto t3 = Clock::now();
+
+			face.triangulation = std::chrono::duration<double>(t2 - t1).count();
+			face.format        = std::chrono::duration<double>((t1 - t0) + (t3 - t2)).count();
+		};
+
+		scheduler.run(ranges, [&](const size_t first, const size_t last)
+		{
+			Zone zone(tracer, "Task");
+
+			std::map<size_t, std::string> index_word;
+
+			std::vector<Point> polygon;
+
+			for( size_t index = first; index < last; index++ )
+				convert(index, index_word, polygon);
+
+			progressFaces.fetch_add(last - first, std::memory_order_relaxed);
+		});
+
+		for( size_t index = 0; index < batch.faces.size(); index++ )
+		{
+			if( !divided(index) ) continue;
+
+			std::map<size_t, std::string> index_word;
+
+			std::vector<Point> polygon;
+
+			convert(index, index_word, polygon);
+
+			progressFaces.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		for( const auto& face : batch.faces )
+		{
+			count += face.count;
+
+			timing.seconds[Profile::Triangulation] += face.triangulation;
+			timing.seconds[Profile::Format]        += face.format;
+
+			timing.add(face.indices.size(), face.triangulation + face.format);
+		}
+	}
+
+	inline std::vector<Triangle> Triangulate::divide(std::vector<Point>& polygon, Scheduler& scheduler)
+	{
+		constexpr size_t PIECE = 256; // Pieces are halved until they have fewer corners
+
+		Zone zone(tracer, "Divide");
+
+		removeConsecutiveEqualItems(polygon);
+
+		if( polygon.size() < PIECE ) return obj::triangulate(polygon, selection);
+
+		const auto normal = obj::normal(polygon);
+
+		std::vector<std::vector<Point>> pieces, level(1, std::move(polygon));
+
+		while( !level.empty() ) // The pieces of one level are halved in parallel
+		{
+			std::vector<std::vector<Point>> halves(level.size() * 2);
+
+			std::vector<Scheduler::Range> ranges;
+
+			for( size_t index = 0; index < level.size(); index++ )
+				ranges.emplace_back(index, index + 1);
+
+			scheduler.run(ranges, [&](const size_t first, const size_t last)
+			{
+				for( size_t index = first; index < last; index++ )
+				{
+					if( level[index].size() < PIECE || !halve(level[index], normal, halves[2 * index], halves[2 * index + 1]) )
+						halves[2 * index].clear();
+				}
+			});
+
+			std::vector<std::vector<Point>> next;
+
+			for( size_t index = 0; index < level.size(); index++ )
+			{
+				if( halves[2 * index].empty() )
+				{
+					pieces.push_back(std::move(level[index]));
+
+					continue;
+				}
+
+				next.push_back(std::move(halves[2 * index]));
+				next.push_back(std::move(halves[2 * index + 1]));
+			}
+
+			level = std::move(next);
+		}
+
+		std::vector<std::vector<Triangle>> parts(pieces.size());
+
+		std::vector<Scheduler::Range> ranges;
+
+		for( size_t index = 0; index < pieces.size(); index++ )
+			ranges.emplace_back(index, index + 1);
+
+		scheduler.run(ranges, [&](const size_t first, const size_t last)
+		{
+			for( size_t index = first; index < last; index++ )
+				parts[index] = obj::triangulate(pieces[index], selection); // Adaptive, cutting the biggest ear gives up on many thin pieces
+		});
+
+		std::vector<Triangle> triangles;
+
+		for( const auto& part : parts )
+			triangles.insert(triangles.end(), part.begin(), part.end());
+
+		timing.divided++;
+		timing.pieces += pieces.size();
+
+		return triangles;
+	}
+
+	inline bool Triangulate::write(const Batch& batch)
+	{
+		if( outputFormat != Output::Obj ) // Only the triangles and, for PLY, the vertices, no lines of the source
+		{
+			std::string block;
+
+			for( const auto& point : batch.vertices )
+			{
+				little(block, static_cast<float>(point.x));
+				little(block, static_cast<float>(point.y));
+				little(block, static_cast<float>(point.z));
+			}
+
+			if( !put(block.data(), block.size()) )
+				return false;
+
+			writtenVertices += batch.vertices.size();
+
+			const auto record = outputFormat == Output::Stl ? STL_TRIANGLE_BYTES : PLY_TRIANGLE_BYTES;
+
+			for( const auto& face : batch.faces )
+			{
+				const auto* text = &face.text;
+
+				if( chunking() && outputFormat == Output::Ply ) // Chunk of every triangle as an extra face property
+				{
+					block.clear();
+
+					for( size_t k = 0; k < face.chunks.size(); k++ )
+					{
+						block.append(face.text, k * record, record);
+
+						little(block, static_cast<uint32_t>(face.chunks[k]));
+					}
+
+					text = &block;
+				}
+
+				if( outputFormat == Output::Ply ? fwrite(text->data(), 1, text->size(), faces) != text->size() : !put(text->data(), text->size()) )
+					return false;
+
+				writtenTriangles += face.text.size() / record;
+			}
+
+			return fits();
+		}
+
+		size_t begin(0), end(0); // Run of untouched lines, written at once
+
+		std::string text; // Face with other line endings or chunk statements
+
+		pending.resize(sorting() ? sections.size() : 0);
+
+		const auto flush = [&]
+		{
+			const char* data = batch.text.data() + begin;
+
+			const auto length = end - begin;
+
+			begin = end;
+
+			return length == 0 || put(data, length);
+		};
+
+		for( const auto& line : batch.lines )
+		{
+			if( line.face == Batch::none )
+			{
+				end = line.offset + line.length;
+
+				continue;
+			}
+
+			if( !flush() )
+				return false;
+
+			begin = end = line.offset + line.length;
+
+			if( line.face == Batch::skip ) continue;
+
+			const auto& item = batch.faces[line.face];
+
+			const auto& face = item.text;
+
+			if( face.empty() ) continue;
+
+			const auto* last = ending(batch, line);
+
+			const auto* separator = obj::separator(batch, line);
+
+			if( *separator == '\n' && !sorting() && !chunking() ) // Triangles are separated by '\n' already
+			{
+				if( !put(face.data(), face.size()) || !put(last, strlen(last)) )
+					return false;
+
+				continue;
+			}
+
+			auto& into = sorting() ? pending[item.section] : text;
+
+			if( sorting() ) // Every triangle gets a line ending, the face may end up before other lines
+			{
+				auto& section = sections[item.section];
+
+				if( section.ending.empty() ) section.ending = separator;
+
+				transition(states[section.last], states[item.state], separator, into);
+
+				section.last = item.state;
+			}
+			else
+				text.clear();
+
+			auto& chunk = sorting() ? sections[item.section].chunk : stream;
+
+			for( size_t from = 0, to = 0, k = 0; from < face.size(); from = to + 1, k++ )
+			{
+				to = std::min(face.find('\n', from), face.size());
+
+				if( chunking() && item.chunks[k] != chunk.written ) // First triangle of a chunk
+				{
+					chunk.written = item.chunks[k];
+
+					into += "o chunk" + std::to_string(chunk.written);
+					into += separator;
+				}
+
+				into.append(face, from, to - from);
+				into += to < face.size() || sorting() ? separator : last;
+			}
+
+			if( !sorting() && !put(text.data(), text.size()) )
+				return false;
+		}
+
+		if( !flush() )
+			return false;
+
+		if( sorting() ) // The sections follow the last line, which may lack a line ending
+			unterminated = *ending(batch, batch.lines.back()) == '\0' && batch.lines.back().face == Batch::none;
+
+		for( size_t index = 0; index < pending.size(); index++ ) // Sorted output, one span per section and batch
+		{
+			auto& text = pending[index];
+
+			if( text.empty() ) continue;
+
+			if( fwrite(text.data(), 1, text.size(), sorted) != text.size() )
+				return false;
+
+			sections[index].spans.emplace_back(sortedBytes, text.size());
+
+			sortedBytes += text.size();
+
+			text.clear();
+		}
+
+		return true;
+	}
+
+	inline bool Triangulate::place(const Batch& batch, Scheduler& scheduler)
+	{
+#ifdef _WIN32
+		return write(batch);
+#else
+		constexpr size_t   TASK_ITEMS = 4096;     // Lines or faces sized by one task
+		constexpr uint64_t TASK_BYTES = 1 << 20;  // Bytes copied by one task
+		constexpr uint64_t GROWTH     = 64 << 20; // The target is allocated ahead in steps of at least this
+
+		const bool stl = outputFormat == Output::Stl; // Only the triangle records, OBJ has every line
+
+		const auto items = stl ? batch.faces.size() : batch.lines.size();
+
+		std::vector<uint64_t> offset(items + 1, 0); // Bytes of every item, then where it starts
+
+		std::vector<Scheduler::Range> ranges;
+
+		for( size_t index = 0; index < items; index += TASK_ITEMS )
+			ranges.emplace_back(index, std::min(items, index + TASK_ITEMS));
+
+		scheduler.run(ranges, [&](const size_t first, const size_t last)
+		{
+			for( size_t index = first; index < last; index++ )
+			{
+				if( stl )
+				{
+					offset[index + 1] = batch.faces[index].text.size();
+
+					continue;
+				}
+
+				const auto& line = batch.lines[index];
+
+				if( line.face == Batch::none )
+					offset[index + 1] = line.length;
+				else if( line.face != Batch::skip && !batch.faces[line.face].text.empty() ) // Triangles apart by the separator instead of '\n'
+				{
+					const auto& face = batch.faces[line.face].text;
+
+					const auto breaks = static_cast<size_t>(std::count(face.begin(), face.end(), '\n'));
+
+					offset[index + 1] = face.size() + breaks * (strlen(separator(batch, line)) - 1) + strlen(ending(batch, line));
+				}
+			}
+		});
+
+		for( size_t index = 0; index < items; index++ )
+			offset[index + 1] += offset[index];
+
+		const auto total = offset[items];
+
+		if( stl )
+			writtenTriangles += total / STL_TRIANGLE_BYTES;
+
+		if( !fits() ) return false;
+
+		if( total == 0 ) return true;
+
+		const int file = fileno(target);
+
+		const auto end = mappedEnd + total;
+
+		if( end > mappedReserved )
+		{
+			const auto reserve = std::max(end, mappedReserved + GROWTH);
+
+#ifdef __linux__
+			if( posix_fallocate(file, static_cast<off_t>(mappedReserved), static_cast<off_t>(reserve - mappedReserved)) != 0 ) // Sparse when the file system cannot allocate
+#endif
+				if( ftruncate(file, static_cast<off_t>(reserve)) != 0 ) return false;
+
+			mappedReserved = reserve;
+		}
+
+		const auto page  = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+		const auto start = mappedEnd / page * page;
+
+		const auto length = static_cast<size_t>(end - start);
+
+		void* data = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, file, static_cast<off_t>(start));
+
+		if( data == MAP_FAILED ) return false;
+
+		char* base = static_cast<char*>(data) + (mappedEnd - start);
+
+		ranges.clear();
+
+		for( size_t index = 0, begin = 0; index < items; index++ ) // About the same bytes per task
+		{
+			if( index + 1 < items && offset[index + 1] - offset[begin] < TASK_BYTES ) continue;
+
+			ranges.emplace_back(begin, index + 1);
+
+			begin = index + 1;
+		}
+
+		scheduler.run(ranges, [&](const size_t first, const size_t last)
+		{
+			for( size_t index = first; index < last; index++ )
+			{
+				char* at = base + offset[index];
+
+				if( stl )
+				{
+					const auto& face = batch.faces[index].text;
+
+					memcpy(at, face.data(), face.size());
+
+					continue;
+				}
+
+				const auto& line = batch.lines[index];
+
+				if( offset[index + 1] == offset[index] ) continue;
+
+				if( line.face == Batch::none )
+				{
+					memcpy(at, batch.text.data() + line.offset, line.length);
+
+					continue;
+				}
+
+				const auto& face = batch.faces[line.face].text;
+
+				const auto* between = separator(batch, line);
+				const auto* last    = ending(batch, line);
+
+				if( *between == '\n' ) // Triangles are separated by '\n' already
+				{
+					memcpy(at, face.data(), face.size());
+					memcpy(at + face.size(), last, strlen(last));
+
+					continue;
+				}
+
+				for( size_t from = 0, to = 0; from < face.size(); from = to + 1 )
+				{
+					to = std::min(face.find('\n', from), face.size());
+
+					const auto* tail = to < face.size() ? between : last;
+
+					memcpy(at, face.data() + from, to - from);
+
+					at += to - from;
+
+					memcpy(at, tail, strlen(tail));
+
+					at += strlen(tail);
+				}
+			}
+		});
+
+		if( munmap(data, length) != 0 ) return false;
+
+		mappedEnd = end;
+
+		timing.mappedBytes += total;
+		timing.mappedWindows++;
+
+		return true;
+#endif
+	}
+
+	inline bool Triangulate::append()
+	{
+		if( sorted != nullptr ) // Sections in the order their material first appeared, each after its usemtl
+		{
+			if( fflush(sorted) != 0 ) return false;
+
+			std::vector<size_t> order(sections.size()); // Material first, then the group order within the material
+
+			std::unordered_map<std::string, size_t> rank;
+
+			for( size_t index = 0; index < sections.size(); index++ )
+			{
+				order[index] = index;
+
+				rank.try_emplace(sections[index].material, index);
+			}
+
+			std::stable_sort(order.begin(), order.end(), [&](const size_t a, const size_t b) { return rank[sections[a].material] < rank[sections[b].material]; });
+
+			State state;
+
+			std::string current, text;
+
+			std::vector<char> block;
+
+			for( const auto index : order )
+			{
+				const auto& section = sections[index];
+
+				if( section.spans.empty() ) continue;
+
+				text.clear();
+
+				if( unterminated ) text += section.ending;
+
+				unterminated = false;
+
+				if( section.material != current )
+				{
+					text += "usemtl " + section.material + section.ending;
+
+					current = section.material;
+
+					count.materials.second++;
+				}
+
+				transition(state, states[section.first], section.ending.c_str(), text);
+
+				state = states[section.last];
+
+				if( !put(text.data(), text.size()) )
+					return false;
+
+				for( const auto& [offset, size] : section.spans )
+				{
+					block.resize(size);
+
+					if( seek(sorted, offset) != 0 || fread(block.data(), 1, size, sorted) != size || !put(block.data(), size) )
+						return false;
+				}
+			}
+		}
+
+		if( faces == nullptr ) return true;
+
+		if( fflush(faces) != 0 || seek(faces, 0) != 0 ) return false;
+
+		std::vector<char> block(4 << 20);
+
+		size_t size(0);
+
+		while( (size = fread(block.data(), 1, block.size(), faces)) > 0 )
+		{
+			if( !put(block.data(), size) )
+				return false;
+		}
+
+		return ferror(faces) == 0;
+	}
+
+	inline size_t Triangulate::section(const std::string& name, const size_t state)
+	{
+		auto key = name;
+
+		if( ordering == Sort::Group )
+			key += '\n' + states[state][0] + '\n' + states[state][1];
+
+		const auto found = sectionIndex.try_emplace(key, sections.size());
+
+		if( found.second )
+		{
+			sections.emplace_back();
+			sections.back().material = name;
+			sections.back().first    = state;
+			sections.back().last     = state;
+		}
+
+		return found.first->second;
+	}
+
+	inline void Triangulate::group(Batch& batch) // Runs of faces whose triangles can trade places, each clustered into chunks
+	{
+		std::vector<size_t> run;
+
+		if( outputFormat != Output::Obj ) // Triangles without a place in the file
+		{
+			for( size_t index = 0; index < batch.faces.size(); index++ )
+				run.push_back(index);
+
+			cluster(batch, run, stream);
+
+			return;
+		}
+
+		if( !sorting() ) // Face lines next to each other, with one vertex count and state
+		{
+			for( const auto& line : batch.lines )
+			{
+				if( line.face < batch.faces.size() )
+				{
+					run.push_back(line.face);
+
+					continue;
+				}
+
+				cluster(batch, run, stream);
+
+				run.clear();
+			}
+
+			cluster(batch, run, stream);
+
+			return;
+		}
+
+		std::vector<std::vector<size_t>> runs(sections.size()); // Faces of one section and state, the indices are absolute
+
+		for( size_t index = 0; index < batch.faces.size(); index++ )
+		{
+			const auto& face = batch.faces[index];
+
+			auto& list = runs[face.section];
+
+			if( !list.empty() && batch.faces[list.front()].state != face.state )
+			{
+				cluster(batch, list, sections[face.section].chunk);
+
+				list.clear();
+			}
+
+			list.push_back(index);
+		}
+
+		for( size_t index = 0; index < runs.size(); index++ )
+			cluster(batch, runs[index], sections[index].chunk);
+	}
+
+	inline void Triangulate::cluster(Batch& batch, const std::vector<size_t>& run, Chunk& chunk)
+	{
+		// A chunk grows by the triangle adding the fewest vertices among the triangles next to it, and
+		// starts from a triangle next to the chunk before, so the chunks are compact and share few vertices
+
+		std::vector<size_t> corners, distinct;
+
+		for( const auto index : run )
+			corners.insert(corners.end(), batch.faces[index].corners.begin(), batch.faces[index].corners.end());
+
+		const auto n = corners.size() / 3;
+
+		if( n == 0 ) return;
+
+		std::vector<std::pair<size_t, size_t>> pairs; // Vertex and triangle, sorted by vertex
+
+		for( size_t t = 0; t < n; t++ )
+		{
+			const auto* c = corners.data() + 3 * t;
+
+			pairs.emplace_back(c[0], t);
+
+			if( c[1] != c[0] ) pairs.emplace_back(c[1], t);
+			if( c[2] != c[0] && c[2] != c[1] ) pairs.emplace_back(c[2], t);
+
+			distinct.push_back(c[2] != c[0] && c[2] != c[1] ? c[1] != c[0] ? 3 : 2 : c[1] != c[0] ? 2 : 1);
+		}
+
+		std::sort(pairs.begin(), pairs.end());
+
+		std::vector<size_t> fresh(distinct), touched, order, chunks;
+
+		std::vector<bool> assigned(n, false);
+
+		std::vector<size_t> queue[3]; // Triangles next to the chunk by the vertices they add, checked when taken
+
+		const auto enter = [&](const size_t vertex) // Vertex joins the chunk
+		{
+			count.chunkVertices++;
+
+			if( vertex >= referenced.size() ) referenced.resize(std::max(vertex + 1, referenced.size() * 2));
+
+			if( referenced[vertex] ) count.duplicated++;
+
+			referenced[vertex] = true;
+
+			for( auto at = std::lower_bound(pairs.begin(), pairs.end(), std::make_pair(vertex, size_t(0))); at != pairs.end() && at->first == vertex; ++at )
+			{
+				if( assigned[at->second] ) continue;
+
+				touched.push_back(at->second);
+
+				queue[--fresh[at->second]].push_back(at->second);
+			}
+		};
+
+		for( const auto& [vertex, t] : pairs ) // Vertices in the chunk left open by the run before
+		{
+			if( chunk.vertices.count(vertex) == 0 ) continue;
+
+			touched.push_back(t);
+
+			queue[--fresh[t]].push_back(t);
+		}
+
+		const auto open = [&]
+		{
+			chunk.id        = count.chunks++;
+			chunk.triangles = 0;
+
+			chunk.vertices.clear();
+
+			for( const auto t : touched )
+				fresh[t] = distinct[t];
+
+			touched.clear();
+
+			for( auto& list : queue )
+				list.clear();
+		};
+
+		size_t cursor(0);
+
+		while( order.size() < n )
+		{
+			auto next = SIZE_MAX;
+
+			for( size_t added = 0; added < 3 && next == SIZE_MAX; added++ )
+			{
+				while( next == SIZE_MAX && !queue[added].empty() )
+				{
+					const auto t = queue[added].back();
+
+					queue[added].pop_back();
+
+					if( !assigned[t] && fresh[t] == added ) next = t;
+				}
+			}
+
+			if( next == SIZE_MAX ) // Nothing next to the chunk, the first triangle left in file order
+			{
+				while( assigned[cursor] ) cursor++;
+
+				next = cursor;
+			}
+
+			const auto room = chunk.id != SIZE_MAX && chunk.vertices.size() + fresh[next] <= chunkVertices && (chunkTriangles == 0 || chunk.triangles < chunkTriangles);
+
+			if( !room ) open();
+
+			assigned[next] = true;
+
+			order.push_back(next);
+			chunks.push_back(chunk.id);
+
+			chunk.triangles++;
+
+			for( int c = 0; c < 3; c++ )
+			{
+				const auto vertex = corners[3 * next + c];
+
+				if( chunk.vertices.insert(vertex).second )
+					enter(vertex);
+			}
+		}
+
+		// The faces of the run take the triangles in the new order, each as many as it had
+
+		const auto record = outputFormat == Output::Stl ? STL_TRIANGLE_BYTES : PLY_TRIANGLE_BYTES;
+
+		std::vector<std::pair<const char*, size_t>> text; // Text of every triangle, in the old faces
+
+		for( const auto index : run )
+		{
+			const auto& face = batch.faces[index].text;
+
+			if( outputFormat != Output::Obj )
+			{
+				for( size_t from = 0; from + record <= face.size(); from += record )
+					text.emplace_back(face.data() + from, record);
+
+				continue;
+			}
+
+			for( size_t from = 0, to = 0; from < face.size(); from = to + 1 )
+			{
+				to = std::min(face.find('\n', from), face.size());
+
+				text.emplace_back(face.data() + from, to - from);
+			}
+		}
+
+		std::vector<std::string> texts(run.size());
+
+		for( size_t r = 0, t = 0; r < run.size(); r++ )
+		{
+			auto& face = batch.faces[run[r]];
+
+			const auto triangles = face.corners.size() / 3;
+
+			face.chunks.clear();
+
+			for( size_t k = 0; k < triangles; k++, t++ )
+			{
+				if( k > 0 && outputFormat == Output::Obj ) texts[r] += '\n';
+
+				texts[r].append(text[order[t]].first, text[order[t]].second);
+
+				std::copy_n(&corners[3 * order[t]], 3, &face.corners[3 * k]);
+
+				face.chunks.push_back(chunks[t]);
+			}
+		}
+
+		for( size_t r = 0; r < run.size(); r++ )
+			batch.faces[run[r]].text.swap(texts[r]);
+	}
+
+	inline bool Triangulate::can_triangulate()
+	{
+		Count temp;
+
+		constexpr int BUFFER_CHAR = 100'000;
+
+		char buff[BUFFER_CHAR] = {0};
+
+		bool vertex(false), polygon(false);
+
+		const std::vector<Point> _;
+
+		while( fgets(buff, sizeof buff, source) )
+		{
+			const char* line = trim(buff);
+
+			if( !polygon && *line == 'f' && *(line + 1) == ' ' )
+			{
+				std::vector<Index> indices;
+
+				if( !parse(line + 2, indices, _, temp) )
+					indices.clear();
+
+				if( indices.size() > 3 )
+					polygon = true;
+			}
+
+			if( !vertex && *line == 'v' && *(line + 1) == ' ' )
+				vertex = true;
+
+			if( vertex && polygon )
+				break;
+		}
+
+		if( !(vertex && polygon) )
+			return error();
+
+		return seek(source, 0) == 0;
+	}
+
+	inline std::string filename(const std::string& file)
+	{
+		const auto find = file.find_last_of("/\\");
+
+		if( find == std::string::npos )
+			return file;
+
+		return file.substr(find + 1);
+	}
+
+	inline std::string buffer(size_t count)
+	{
+		static const size_t length = std::to_string(SIZE_MAX).length();
+
+		std::string buffer = std::string(count * length, ' ');
+
+		return buffer;
+	}
+
+	inline bool readline(FILE* file, std::string& line)
+	{
+		constexpr int BUFFER_CHAR = 100'000;
+
+		char buff[BUFFER_CHAR];
+
+		line.clear();
+
+		while( fgets(buff, sizeof buff, file) )
+		{
+			line += buff;
+
+			if( line.back() == '\n' )
+				return true;
+		}
+
+		return !line.empty();
+	}
+
+	inline bool Selection::load(const std::string& file)
+	{
+		FILE* input = fopen(file.c_str(), "rb");
+
+		if( input == nullptr ) return false;
+
+		auto read = *this;
+
+		std::string line;
+
+		bool valid(true);
+
+		while( valid && readline(input, line) )
+		{
+			char name[16];
+
+			size_t value(0);
+
+			const char* text = line.c_str();
+
+			while( std::isspace(static_cast<unsigned char>(*text)) ) text++;
+
+			if( *text == '\0' || *text == '#' ) continue;
+
+			valid = sscanf(text, "%15s %zu", name, &value) == 2;
+
+			if( !valid ) break;
+
+			if( strcmp(name, "cut") == 0 ) read.cut = value;
+			else if( strcmp(name, "sweep") == 0 ) read.sweep = value;
+			else if( strcmp(name, "grid") == 0 ) read.grid = value;
+			else valid = false;
+		}
+
+		fclose(input);
+
+		if( valid ) *this = read;
+
+		return valid;
+	}
+
+	inline bool Selection::save(const std::string& file) const
+	{
+		FILE* output = fopen(file.c_str(), "wb");
+
+		if( output == nullptr ) return false;
+
+		fprintf(output, "# TriangulateOBJ engine thresholds in corners (0 = never), written by --calibrate\n");
+		fprintf(output, "cut %zu\n", cut);
+		fprintf(output, "sweep %zu\n", sweep);
+		fprintf(output, "grid %zu\n", grid);
+
+		return fclose(output) == 0;
+	}
+
+	//-------------------------------------------------------------------------------------------------------
+
+	inline Monitor::Monitor(const std::function<void()>& tick, const double interval) : stop(false)
+	{
+		const auto period = std::chrono::duration<double>(std::max(0.01, interval));
+
+		thread = std::thread([this, tick, period]
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+
+			while( !wake.wait_for(lock, period, [this] { return stop; }) )
+			{
+				lock.unlock();
+
+				tick();
+
+				lock.lock();
+			}
+		});
+	}
+
+	inline Monitor::~Monitor()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			stop = true;
+		}
+
+		wake.notify_all();
+
+		thread.join();
+	}
+
+	inline uint64_t Weld::cell(const double x, const double y, const double z) const
+	{
+		const auto hash = [](const double value) { return static_cast<uint64_t>(static_cast<int64_t>(std::clamp(std::floor(value), -9e18, 9e18))); };
+
+		return hash(x) * 0x9e3779b97f4a7c15ull ^ hash(y) * 0xc2b2ae3d27d4eb4full ^ hash(z) * 0x165667b19e3779f9ull;
+	}
+
+	inline bool Weld::add(const Point& point)
+	{
+		// Exact welding hashes the bits of the position, otherwise the cells are one tolerance wide and a twin is in one of 27 cells
+
+		const auto key = [&](const int dx, const int dy, const int dz) -> uint64_t
+		{
+			if( tolerance > 0 )
+				return cell(point.x / tolerance + dx, point.y / tolerance + dy, point.z / tolerance + dz);
+
+			const auto bits = [](const Real value)
+			{
+				uint64_t word(0);
+
+				const Real zero = value == 0 ? Real(0) : value; // -0 and +0 are one position
+
+				memcpy(&word, &zero, sizeof zero);
+
+				return word;
+			};
+
+			return bits(point.x) * 0x9e3779b97f4a7c15ull ^ bits(point.y) * 0xc2b2ae3d27d4eb4full ^ bits(point.z) * 0x165667b19e3779f9ull;
+		};
+
+		const auto twin = [&](const uint64_t hash)
+		{
+			const auto found = head.find(hash);
+
+			for( auto index = found == head.end() ? SIZE_MAX : found->second; index != SIZE_MAX; index = next[index] )
+			{
+				const auto& other = position[index];
+
+				if( std::fabs(other.x - point.x) <= tolerance && std::fabs(other.y - point.y) <= tolerance && std::fabs(other.z - point.z) <= tolerance )
+					return index;
+			}
+
+			return SIZE_MAX;
+		};
+
+		const int reach = tolerance > 0.0f ? 1 : 0;
+
+		for( int dx = -reach; dx <= reach; dx++ )
+		{
+			for( int dy = -reach; dy <= reach; dy++ )
+			{
+				for( int dz = -reach; dz <= reach; dz++ )
+				{
+					const auto index = twin(key(dx, dy, dz));
+
+					if( index == SIZE_MAX ) continue;
+
+					to.push_back(index);
+
+					return false;
+				}
+			}
+		}
+
+		const auto index = position.size();
+
+		const auto slot = head.try_emplace(key(0, 0, 0), SIZE_MAX).first;
+
+		next.push_back(slot->second);
+
+		slot->second = index;
+
+		position.push_back({point.x, point.y, point.z});
+
+		to.push_back(index);
+
+		return true;
+	}
+
+	inline void Weld::relabel(std::map<size_t, std::string>& index_word, std::vector<Point>& polygon) const
+	{
+		std::map<size_t, std::string> words;
+
+		for( const auto& [index, word] : index_word )
+		{
+			if( index >= to.size() || words.count(to[index]) != 0 ) continue;
+
+			const auto slash = word.find('/');
+
+			words[to[index]] = std::to_string(to[index] + 1) + (slash == std::string::npos ? std::string() : word.substr(slash));
+		}
+
+		index_word.swap(words);
+
+		for( auto& point : polygon )
+		{
+			if( point.i < to.size() ) point.i = static_cast<Vertex>(to[point.i]);
+		}
+	}
+
+	inline Point& Store::operator[](const size_t index)
+	{
+		return blocks[index / BLOCK].data[index % BLOCK];
+	}
+
+	inline const Point& Store::operator[](const size_t index) const
+	{
+		return blocks[index / BLOCK].data[index % BLOCK];
+	}
+
+	inline size_t Store::bytes()
+	{
+		return BLOCK * sizeof(Point);
+	}
+
+	inline bool Store::reset(const size_t limit)
+	{
+		if( budget > 0 || limit > 0 ) // Blocks in memory are kept for the next source, like the capacity of a vector
+			release();
+
+		budget  = limit;
+		count   = 0;
+		written = 0;
+		loaded  = 0;
+
+		if( budget > 0 && (file = tmpfile()) == nullptr ) return false;
+
+		return true;
+	}
+
+	inline void Store::release()
+	{
+		for( size_t block = 0; block < blocks.size(); block++ )
+		{
+			if( blocks[block].data == nullptr ) continue;
+
+#ifndef _WIN32
+			if( blocks[block].mapped )
+				munmap(blocks[block].data, bytes());
+			else
+#endif
+				delete[] blocks[block].data;
+		}
+
+		blocks.clear();
+		recent.clear();
+
+		resident = 0;
+
+		if( file ) fclose(file);
+
+		file = nullptr;
+	}
+
+	inline bool Store::append(const std::vector<Point>& points)
+	{
+		for( size_t done = 0; done < points.size(); )
+		{
+			const auto block = count / BLOCK;
+			const auto at    = count % BLOCK;
+
+			if( block == blocks.size() )
+				blocks.emplace_back();
+
+			if( blocks[block].data == nullptr )
+			{
+				if( budget > 0 ) trim(bytes(), nullptr);
+
+				blocks[block].data = new Point[BLOCK];
+
+				resident++;
+			}
+
+			const auto take = std::min(points.size() - done, BLOCK - at);
+
+			std::copy(points.begin() + done, points.begin() + done + take, blocks[block].data + at);
+
+			done  += take;
+			count += take;
+
+			if( budget == 0 || count % BLOCK != 0 ) continue;
+
+			// A full block goes to the file and may be evicted from now on, the blocks are written in order
+
+			if( seek(file, written) != 0 || fwrite(blocks[block].data, sizeof(Point), BLOCK, file) != BLOCK ) return false;
+
+			written += bytes();
+
+			recent.push_front(block);
+
+			blocks[block].use = recent.begin();
+		}
+
+		return true;
+	}
+
+	inline void Store::resize(const size_t size)
+	{
+		while( blocks.size() * BLOCK < size )
+			blocks.emplace_back();
+
+		for( size_t block = 0; block * BLOCK < size; block++ )
+		{
+			if( blocks[block].data != nullptr ) continue;
+
+			blocks[block].data = new Point[BLOCK];
+
+			resident++;
+		}
+
+		count = size;
+	}
+
+	inline void Store::trim(const size_t incoming, const std::vector<char>* keep)
+	{
+		while( !recent.empty() && resident * bytes() + incoming > budget && (keep == nullptr || !(*keep)[recent.back()]) )
+			evict(recent.back());
+	}
+
+	inline void Store::evict(const size_t block)
+	{
+		auto& item = blocks[block];
+
+#ifndef _WIN32
+		if( item.mapped )
+			munmap(item.data, bytes());
+		else
+#endif
+			delete[] item.data;
+
+		item.data   = nullptr;
+		item.mapped = false;
+
+		recent.erase(item.use);
+
+		resident--;
+	}
+
+	inline bool Store::load(const size_t block)
+	{
+		auto& item = blocks[block];
+
+		const auto offset = static_cast<uint64_t>(block) * bytes();
+
+#ifndef _WIN32
+		void* data = mmap(nullptr, bytes(), PROT_READ, MAP_PRIVATE, fileno(file), static_cast<off_t>(offset));
+
+		if( data == MAP_FAILED ) return false;
+
+		item.data   = static_cast<Point*>(data);
+		item.mapped = true;
+#else
+		item.data = new Point[BLOCK];
+
+		if( seek(file, offset) != 0 || fread(item.data, sizeof(Point), BLOCK, file) != BLOCK )
+		{
+			delete[] item.data;
+
+			item.data = nullptr;
+
+			return false;
+		}
+#endif
+
+		recent.push_front(block);
+
+		item.use = recent.begin();
+
+		resident++;
+		loaded++;
+
+		return true;
+	}
+
+	inline bool Store::pin(const Batch& batch)
+	{
+		if( budget == 0 ) return true;
+
+		needed.assign(blocks.size(), 0);
+
+		std::vector<size_t> missing;
+
+		for( const auto& face : batch.faces )
+		{
+			for( const auto index : face.indices )
+			{
+				if( index < 0 || static_cast<size_t>(index) >= face.vertices ) continue;
+
+				const auto block = static_cast<size_t>(index) / BLOCK;
+
+				if( needed[block] ) continue;
+
+				needed[block] = 1;
+
+				if( blocks[block].data == nullptr )
+					missing.push_back(block);
+				else if( block * BLOCK + BLOCK <= count ) // Touched first, so loading never evicts a block the batch uses
+					recent.splice(recent.begin(), recent, blocks[block].use);
+			}
+		}
+
+		if( missing.empty() ) return true;
+
+		if( fflush(file) != 0 ) return false;
+
+		std::sort(missing.begin(), missing.end()); // File order
+
+		for( const auto block : missing )
+		{
+			trim(bytes(), &needed); // A batch that uses more blocks than the budget holds gets them all, the budget is met again later
+
+			if( !load(block) ) return false;
+		}
+
+		return true;
+	}
+
+	inline bool Ring::open(const int source, const uint64_t size, const int target, const uint64_t offset)
+	{
+		close();
+
+#ifdef __linux__
+		io_uring_params params;
+
+		memset(&params, 0, sizeof params);
+
+		ring = static_cast<int>(syscall(__NR_io_uring_setup, static_cast<unsigned>(2 * BUFFERS), &params));
+
+		if( ring < 0 ) return false;
+
+		sqBytes  = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+		cqBytes  = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		sqeBytes = params.sq_entries * sizeof(io_uring_sqe);
+
+		const bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0; // Both rings in one mapping
+
+		if( single ) sqBytes = cqBytes = std::max(sqBytes, cqBytes);
+
+		const auto map = [&](const size_t bytes, const off_t what)
+		{
+			void* data = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, what);
+
+			return data == MAP_FAILED ? nullptr : data;
+		};
+
+		sq      = map(sqBytes, IORING_OFF_SQ_RING);
+		cq      = single ? sq : map(cqBytes, IORING_OFF_CQ_RING);
+		entries = map(sqeBytes, IORING_OFF_SQES);
+
+		void* buffer = mmap(nullptr, 2 * BUFFERS * BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+		memory = buffer == MAP_FAILED ? nullptr : static_cast<char*>(buffer);
+
+		if( sq == nullptr || cq == nullptr || entries == nullptr || memory == nullptr )
+		{
+			close();
+
+			return false;
+		}
+
+		auto* s = static_cast<char*>(sq);
+		auto* c = static_cast<char*>(cq);
+
+		sqHead  = reinterpret_cast<unsigned*>(s + params.sq_off.head);
+		sqTail  = reinterpret_cast<unsigned*>(s + params.sq_off.tail);
+		sqMask  = reinterpret_cast<unsigned*>(s + params.sq_off.ring_mask);
+		sqArray = reinterpret_cast<unsigned*>(s + params.sq_off.array);
+		cqHead  = reinterpret_cast<unsigned*>(c + params.cq_off.head);
+		cqTail  = reinterpret_cast<unsigned*>(c + params.cq_off.tail);
+		cqMask  = reinterpret_cast<unsigned*>(c + params.cq_off.ring_mask);
+
+		events = c + params.cq_off.cqes;
+
+		iovec vectors[2 * BUFFERS];
+
+		for( size_t index = 0; index < 2 * BUFFERS; index++ )
+		{
+			buffers[index] = Buffer();
+
+			buffers[index].data = memory + index * BYTES;
+
+			vectors[index].iov_base = buffers[index].data;
+			vectors[index].iov_len  = BYTES;
+		}
+
+		fixed = syscall(__NR_io_uring_register, ring, IORING_REGISTER_BUFFERS, vectors, static_cast<unsigned>(2 * BUFFERS)) == 0; // Plain reads and writes when locked memory is short
+
+		input      = source;
+		output     = target;
+		sourceSize = size;
+		nextRead   = 0;
+		current    = 0;
+		consumed   = 0;
+		nextWrite  = offset;
+		filling    = 0;
+		filled     = 0;
+		failed     = false;
+		readCount  = 0;
+		writeCount = 0;
+
+		if( input >= 0 )
+			for( size_t buffer = 0; buffer < BUFFERS; buffer++ )
+				issue(buffer);
+
+		return true;
+#else
+		(void)source;
+		(void)size;
+		(void)target;
+		(void)offset;
+
+		return false;
+#endif
+	}
+
+	inline void Ring::close()
+	{
+#ifdef __linux__
+		const auto busy = [&] { return std::any_of(buffers, buffers + 2 * BUFFERS, [](const Buffer& item) { return item.busy; }); };
+
+		while( ring >= 0 && busy() && wait() ) {} // The kernel may still fill or read the buffers
+
+		if( memory ) munmap(memory, 2 * BUFFERS * BYTES);
+		if( entries ) munmap(entries, sqeBytes);
+		if( cq && cq != sq ) munmap(cq, cqBytes);
+		if( sq ) munmap(sq, sqBytes);
+		if( ring >= 0 ) ::close(ring);
+#endif
+		ring   = -1;
+		input  = -1;
+		output = -1;
+
+		memory  = nullptr;
+		entries = nullptr;
+		events  = nullptr;
+		sq      = nullptr;
+		cq      = nullptr;
+
+		for( auto& item : buffers )
+			item = Buffer();
+	}
+
+	inline size_t Ring::read(char* data, const size_t size)
+	{
+		size_t copied(0);
+
+		while( copied < size && !failed )
+		{
+			auto& item = buffers[current];
+
+			while( item.busy && wait() ) {}
+
+			if( failed || item.length == 0 ) break; // The end of the source
+
+			const auto take = std::min(size - copied, item.done - consumed);
+
+			memcpy(data + copied, item.data + consumed, take);
+
+			copied   += take;
+			consumed += take;
+
+			if( consumed < item.done ) continue;
+
+			issue(current); // The block after the last one asked for
+
+			current  = (current + 1) % BUFFERS;
+			consumed = 0;
+		}
+
+		return copied;
+	}
+
+	inline bool Ring::write(const char* data, size_t size)
+	{
+		while( size > 0 && !failed )
+		{
+			auto& item = buffers[BUFFERS + filling];
+
+			while( item.busy && wait() ) {} // Still on its way from the last round
+
+			if( failed ) break;
+
+			const auto take = std::min(size, BYTES - filled);
+
+			memcpy(item.data + filled, data, take);
+
+			filled += take;
+			data   += take;
+			size   -= take;
+
+			if( filled == BYTES ) send();
+		}
+
+		return !failed;
+	}
+
+	inline bool Ring::flush()
+	{
+		if( ring < 0 ) return true;
+
+		if( output >= 0 && filled > 0 && !failed ) send();
+
+		const auto busy = [&] { return std::any_of(buffers + BUFFERS, buffers + 2 * BUFFERS, [](const Buffer& item) { return item.busy; }); };
+
+		while( busy() && wait() ) {}
+
+		return !failed;
+	}
+
+	inline void Ring::issue(const size_t buffer)
+	{
+		auto& item = buffers[buffer];
+
+		item.offset = nextRead;
+		item.length = static_cast<size_t>(std::min<uint64_t>(BYTES, sourceSize - nextRead));
+		item.done   = 0;
+
+		nextRead += item.length;
+
+		if( item.length > 0 ) submit(buffer);
+	}
+
+	inline void Ring::send()
+	{
+		const auto buffer = BUFFERS + filling;
+
+		auto& item = buffers[buffer];
+
+		item.offset = nextWrite;
+		item.length = filled;
+		item.done   = 0;
+
+		nextWrite += filled;
+
+		filling = (filling + 1) % BUFFERS;
+		filled  = 0;
+
+		submit(buffer);
+	}
+
+	inline void Ring::submit(const size_t buffer)
+	{
+#ifdef __linux__
+		auto& item = buffers[buffer];
+
+		const bool reads = buffer < BUFFERS;
+
+		const auto tail  = *sqTail;
+		const auto index = tail & *sqMask;
+
+		auto& entry = static_cast<io_uring_sqe*>(entries)[index];
+
+		memset(&entry, 0, sizeof entry);
+
+		entry.opcode    = static_cast<uint8_t>(fixed ? (reads ? IORING_OP_READ_FIXED : IORING_OP_WRITE_FIXED) : (reads ? IORING_OP_READ : IORING_OP_WRITE));
+		entry.fd        = reads ? input : output;
+		entry.off       = item.offset + item.done;
+		entry.addr      = reinterpret_cast<uint64_t>(item.data + item.done);
+		entry.len       = static_cast<uint32_t>(item.length - item.done);
+		entry.buf_index = static_cast<uint16_t>(fixed ? buffer : 0);
+		entry.user_data = buffer;
+
+		sqArray[index] = index;
+
+		__atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+
+		item.busy = true;
+
+		while( syscall(__NR_io_uring_enter, ring, 1u, 0u, 0u, nullptr, 0) < 0 )
+		{
+			if( errno == EINTR ) continue;
+
+			item.busy = false;
+			failed    = true;
+
+			break;
+		}
+#else
+		(void)buffer;
+#endif
+	}
+
+	inline bool Ring::wait()
+	{
+#ifdef __linux__
+		while( syscall(__NR_io_uring_enter, ring, 0u, 1u, static_cast<unsigned>(IORING_ENTER_GETEVENTS), nullptr, 0) < 0 )
+		{
+			if( errno == EINTR ) continue;
+
+			failed = true;
+
+			return false;
+		}
+
+		auto head = *cqHead;
+
+		while( head != __atomic_load_n(cqTail, __ATOMIC_ACQUIRE) )
+		{
+			const auto& event = static_cast<io_uring_cqe*>(events)[head & *cqMask];
+
+			const auto buffer = static_cast<size_t>(event.user_data);
+			const auto result = event.res;
+
+			__atomic_store_n(cqHead, ++head, __ATOMIC_RELEASE);
+
+			complete(buffer, result);
+		}
+
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	inline void Ring::complete(const size_t buffer, const int result)
+	{
+		auto& item = buffers[buffer];
+
+		item.busy = false;
+
+		if( result < 0 )
+		{
+			failed = true;
+
+			return;
+		}
+
+		if( buffer < BUFFERS ) readCount++; else writeCount++;
+
+		item.done += static_cast<size_t>(result);
+
+		if( result == 0 ) // The source ended early, or the target can not grow
+		{
+			if( buffer < BUFFERS ) item.length = item.done; else failed = true;
+
+			return;
+		}
+
+		if( item.done < item.length ) submit(buffer); // Short read or write, the rest
+	}
+
+	inline std::vector<Trace::Event>& Trace::buffer()
+	{
+		thread_local uint64_t owner = 0;
+
+		thread_local std::vector<Event>* events = nullptr;
+
+		if( owner != session )
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			buffers.emplace_back(std::make_unique<std::vector<Event>>());
+
+			buffers.back()->reserve(4096);
+
+			events = buffers.back().get();
+			owner  = session;
+		}
+
+		return *events;
+	}
+
+	inline bool Trace::write(const std::string& file) const
+	{
+		FILE* out = fopen(file.c_str(), "w");
+
+		if( out == nullptr )
+		{
+			std::cout << "Impossible to open trace file for write!" << std::endl;
+
+			return false;
+		}
+
+		const auto us = [this](const Clock::time_point time) { return std::chrono::duration<double, std::micro>(time - start).count(); };
+
+		fprintf(out, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+
+		fprintf(out, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, \"args\": {\"name\": \"TriangulateOBJ\"}}");
+
+		for( size_t tid = 0; tid < buffers.size(); tid++ ) // The first thread to add an event is the one converting
+		{
+			const auto thread = tid == 0 ? std::string("main") : "thread " + std::to_string(tid);
+
+			fprintf(out, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %zu, \"args\": {\"name\": \"%s\"}}", tid + 1, thread.c_str());
+
+			for( const auto& event : *buffers[tid] )
+			{
+				fprintf(out, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %zu, \"ts\": %.3f, \"dur\": %.3f", event.name, tid + 1, us(event.start), us(event.stop) - us(event.start));
+
+				if( event.corners != SIZE_MAX )
+					fprintf(out, ", \"args\": {\"corners\": %zu}", event.corners);
+
+				fprintf(out, "}");
+			}
+		}
+
+		fprintf(out, "\n]}\n");
+
+		return fclose(out) == 0;
+	}
+
+	inline Scheduler::Scheduler(const size_t threads) : worker(std::max<size_t>(1, threads)), job(nullptr), generation(0), active(0), stop(false)
+	{
+		for( size_t id = 0; id < worker.size(); id++ )
+			queue.emplace_back(std::make_unique<Queue>());
+
+		for( size_t id = 1; id < worker.size(); id++ )
+			thread.emplace_back(&Scheduler::loop, this, id);
+	}
+
+	inline Scheduler::~Scheduler()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			stop = true;
+		}
+
+		wake.notify_all();
+
+		for( auto& item : thread )
+			item.join();
+	}
+
+	inline void Scheduler::run(const std::vector<Range>& ranges, const Task& task)
+	{
+		if( ranges.empty() ) return;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			job = &task;
+
+			// Contiguous blocks per worker keep neighbouring faces on the same core until stolen
+
+			for( size_t index = 0; index < ranges.size(); index++ )
+			{
+				Queue& own = *queue[index * queue.size() / ranges.size()];
+
+				std::lock_guard<std::mutex> guard(own.mutex);
+
+				own.ranges.push_back(ranges[index]);
+			}
+
+			active = thread.size();
+
+			generation++;
+		}
+
+		wake.notify_all();
+
+		work(0);
+
+		std::unique_lock<std::mutex> lock(mutex);
+
+		done.wait(lock, [this] { return active == 0; });
+
+		job = nullptr;
+	}
+
+	inline void Scheduler::loop(const size_t id)
+	{
+		size_t seen(0);
+
+		while( true )
+		{
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+
+				wake.wait(lock, [&] { return stop || generation != seen; });
+
+				if( stop ) return;
+
+				seen = generation;
+			}
+
+			work(id);
+
+			std::lock_guard<std::mutex> lock(mutex);
+
+			if( --active == 0 )
+				done.notify_all();
+		}
+	}
+
+	inline void Scheduler::work(const size_t id)
+	{
+		using Clock = std::chrono::steady_clock;
+
+		Range range;
+
+		while( pop(id, range) || steal(id, range) )
+		{
+			const auto start = Clock::now();
+
+			(*job)(range.first, range.second);
+
+			worker[id].busy += std::chrono::duration<double>(Clock::now() - start).count();
+			worker[id].tasks++;
+		}
+	}
+
+	inline bool Scheduler::pop(const size_t id, Range& range)
+	{
+		Queue& own = *queue[id];
+
+		std::lock_guard<std::mutex> lock(own.mutex);
+
+		if( own.ranges.empty() ) return false;
+
+		range = own.ranges.back();
+
+		own.ranges.pop_back();
+
+		return true;
+	}
+
+	inline bool Scheduler::steal(const size_t id, Range& range)
+	{
+		for( size_t offset = 1; offset < queue.size(); offset++ )
+		{
+			Queue& other = *queue[(id + offset) % queue.size()];
+
+			std::lock_guard<std::mutex> lock(other.mutex);
+
+			if( other.ranges.empty() ) continue;
+
+			range = other.ranges.front();
+
+			other.ranges.pop_front();
+
+			worker[id].steals++;
+
+			return true;
+		}
+
+		return false;
+	}
+
+	//-------------------------------------------------------------------------------------------------------
+
+	template<typename Integer>
+	inline bool strtoi(const char* text, Integer& i, const char*& end) // False without digits, or when the value does not fit
+	{
+		const char* p = text;
+
+		bool negative = false;
+
+		while( *p == ' ' || *p == '\t' ) p++;
+
+		if( *p == '-' )
+		{
+			negative = true;
+
+			p++;
+		}
+		else if( *p == '+' )
+			p++;
+
+		constexpr auto most = static_cast<uint64_t>(std::numeric_limits<Integer>::max());
+
+		uint64_t v = 0;
+
+		bool fits = true;
+
+		while( *p >= '0' && *p <= '9' )
+		{
+			const auto digit = static_cast<uint64_t>(*p - '0');
+
+			fits = fits && v <= (most - digit) / 10;
+
+			v = (v * 10) + digit;
+
+			p++;
+		}
+
+		end = p;
+
+		i = negative ? -static_cast<Integer>(v) : static_cast<Integer>(v);
+
+		return text != end && fits;
+	}
+
+	inline bool strtof(const char* text, Real& d, const char*& end)
+	{
+		const char* p = text;
+
+		bool negative = false;
+
+		while( *p == ' ' || *p == '\t' ) p++;
+
+		if( *p == '-' )
+		{
+			negative = true;
+
+			p++;
+		}
+		else if( *p == '+' )
+			p++;
+
+		Real v = 0;
+
+		while( *p >= '0' && *p <= '9' )
+		{
+			v = v * 10 + static_cast<Real>(*p - '0');
+
+			p++;
+		}
+
+		if( *p == '.' )
+		{
+			p++;
+
+			Real factor = static_cast<Real>(0.1);
+
+			while( *p >= '0' && *p <= '9' )
+			{
+				v += factor * static_cast<Real>(*p - '0');
+
+				factor *= static_cast<Real>(0.1);
+
+				p++;
+			}
+		}
+
+		if( *p == 'e' || *p == 'E' )
+		{
+			++p;
+
+			int exponent = 0;
+
+			bool negExp = false;
+
+			if( *p == '-' )
+			{
+				negExp = true;
+
+				p++;
+			}
+			else if( *p == '+' )
+			{
+				p++;
+			}
+
+			while( *p >= '0' && *p <= '9' )
+			{
+				exponent = exponent * 10 + (*p - '0');
+
+				p++;
+			}
+
+			v *= static_cast<Real>(pow(10.0, negExp ? -exponent : exponent));
+		}
+
+		end = p;
+
+		d = negative ? -v : v;
+
+		return text == end ? false : true;
+	}
+
+	inline bool skim(const char* text, const char*& end) // The characters strtof() takes, without the arithmetic, so lazy vertices are checked alike
+	{
+		const char* p = text;
+
+		while( *p == ' ' || *p == '\t' ) p++;
+
+		if( *p == '-' || *p == '+' ) p++;
+
+		while( *p >= '0' && *p <= '9' ) p++;
+
+		if( *p == '.' )
+		{
+			p++;
+
+			while( *p >= '0' && *p <= '9' ) p++;
+		}
+
+		if( *p == 'e' || *p == 'E' )
+		{
+			p++;
+
+			if( *p == '-' || *p == '+' ) p++;
+
+			while( *p >= '0' && *p <= '9' ) p++;
+		}
+
+		end = p;
+
+		return text == end ? false : true;
+	}
+
+	inline size_t words(const char* text, const size_t most) // Words up to the end of the line, counting stops at most
+	{
+		size_t n(0);
+
+		while( n < most )
+		{
+			while( isspace(*text) ) text++;
+
+			if( iseol(*text) ) break;
+
+			n++;
+
+			while( !isspace(*text) && !iseol(*text) ) text++;
+		}
+
+		return n;
+	}
+
+	inline std::string statement(const char* text) // Rest of the line, without the surrounding white space
+	{
+		while( isspace(*text) ) text++;
+
+		const char* end = text;
+
+		while( !iseol(*end) ) end++;
+
+		while( end > text && isspace(*(end - 1)) ) end--;
+
+		return std::string(text, end);
+	}
+
+	inline bool strtoword(const char* text, std::string& word, const char*& end)
+	{
+		const char* p = text;
+
+		while( isspace(*p) ) p++;
+
+		const char* e = p;
+
+		while( !isspace(*e) && !iseol(*e) ) e++;
+
+		end = e;
+
+		word = std::string(p, e);
+
+		return text == end || word.empty() ? false : true;
+	}
+	//-------------------------------------------------------------------------------------------------------
+
+	inline bool iseol(const char& c)
+	{
+		return c == '\r' || c == '\n' || c == '\0';
+	}
+
+	inline bool isspace(const char& c)
+	{
+		return c == ' ' || c == '\t' || c == '\v';
+	}
+
+	inline char* trim(char* p)
+	{
+		if( p == nullptr ) return nullptr;
+
+		while( std::isspace(*p) ) p++;
+
+		if( *p == '\0' ) return p; // Nothing to trim, and no terminator to write past the line
+
+		char* e = p;
+
+		while( *e != '\0' ) e++;
+
+		if( e != p ) e--;
+
+		while( std::isspace(*e) && e != p ) e--;
+
+		e++;
+
+		*e = '\0';
+
+		return p;
+	}
+
+	//-------------------------------------------------------------------------------------------------------
+
+	inline bool parse(const char* line, Point& point, Count& count)
+	{
+		if( !strtof(line, point.x, line) )
+			return false;
+
+		if( !strtof(line, point.y, line) )
+			return false;
+
+		if( !strtof(line, point.z, line) )
+			return false;
+
+		point.i = static_cast<Vertex>(count.vertices++);
+
+		return true;
+	}
+
+	inline Index listIndex(Index index, Index listSize)
+	{
+		return index > 0 ? index - 1 : index + listSize;
+	}
+
+	inline bool parse(const char* line, std::vector<Index>& indices, const std::vector<Point>& vertex, Count&) // The count is kept for callers of the baseline signature
+	{
+		return parse(line, indices, vertex.size());
+	}
+
+	inline bool parse(const char* line, std::vector<Index>& indices, const size_t vertices)
+	{
+		Index index;
+
+		const auto size = static_cast<Index>(vertices);
+
+		while( !iseol(*line) )
+		{
+			if( !strtoi(line, index, line) )
+				return false;
+
+			index = listIndex(index, size);
+
+			indices.emplace_back(index);
+
+			while( !isspace(*line) && !iseol(*line) )
+				line++;
+		}
+
+		return true;
+	}
+
+	inline bool indexed(const char* line, const size_t vertices) // A triangle gather() keeps as it is: three words starting with distinct indices of known vertices
+	{
+		Index corner[3];
+
+		size_t n(0);
+
+		const auto size = static_cast<Index>(vertices);
+
+		while( true )
+		{
+			while( isspace(*line) ) line++;
+
+			if( iseol(*line) ) return n == 3;
+
+			Index index;
+
+			if( n == 3 || !strtoi(line, index, line) )
+				return false;
+
+			index = listIndex(index, size); // 0 and indices past the vertices land outside the list
+
+			if( index < 0 || index >= size )
+				return false;
+
+			for( size_t k = 0; k < n; k++ )
+			{
+				if( corner[k] == index ) return false;
+			}
+
+			corner[n++] = index;
+
+			while( !isspace(*line) && !iseol(*line) )
+				line++;
+		}
+	}
+
+	char* triangulate(char* line, const std::vector<Index>&, std::vector<Point>&, Count&);
+
+	inline char* parse(char* line, std::vector<Point>& vertex, Count& count)
+	{
+		line = trim(line);
+
+		if( *line == 'f' && *(line + 1) == ' ' )
+		{
+			std::vector<Index> indices;
+
+			if( !parse(line + 2, indices, vertex, count) )
+				return nullptr;
+
+			return triangulate(line, indices, vertex, count);
+		}
+
+		if( *line == 'v' && *(line + 1) == ' ' )
+		{
+			Point point;
+
+			if( !parse(line + 2, point, count) )
+				return nullptr;
+
+			vertex.emplace_back(point);
+		}
+
+		return line;
+	}
+
+	std::vector<Triangle> triangulate(std::vector<Point>&);
+
+	template<typename Vertices> // A std::vector<Point> or a Store
+	inline bool gather(const char* line, const std::vector<Index>& indices, const Vertices& vertex, const size_t vertices, Count& count, std::map<size_t, std::string>& index_word, std::vector<Point>& polygon)
+	{
+		if( line == nullptr || *line != 'f' )
+			return false;
+
+		const auto initialCountOfIndices = indices.size();
+
+		if( initialCountOfIndices < 3 )
+			return false;
+
+		if( initialCountOfIndices == 3 )
+			count.triangles.first++;
+
+		if( initialCountOfIndices > 3 )
+			count.polygons.first++;
+
+		line++;
+
+		std::string text;
+
+		index_word.clear();
+
+		const auto size = static_cast<Index>(vertices);
+
+		while( strtoword(line, text, line) )
+		{
+			Index index;
+
+			const char* word = text.c_str();
+
+			if( !strtoi(word, index, word) )
+				return false;
+
+			index = listIndex(index, size);
+
+			if( index_word.count(index) == 0 )
+				index_word[index] = text;
+		}
+
+		if( initialCountOfIndices > 3 )
+			count.polygons.second++;
+
+		polygon.clear();
+
+		for( const auto& index : indices )
+		{
+			if( index >= 0 && index < size )
+				polygon.emplace_back(vertex[index]);
+		}
+
+		return true;
+	}
+
+	inline bool format(const std::vector<Triangle>& triangles, std::map<size_t, std::string>& index_word, Count& count, std::string& face)
+	{
+		face.clear();
+
+		if( triangles.empty() )
+			return false;
+
+		for( const auto& triangle : triangles )
+		{
+			if( !face.empty() ) face += '\n';
+
+			face += "f ";
+			face += index_word[triangle.p0.i];
+			face += ' ';
+			face += index_word[triangle.p1.i];
+			face += ' ';
+			face += index_word[triangle.p2.i];
+
+			count.triangles.second++;
+		}
+
+		return true;
+	}
+
+	inline void absolute(std::map<size_t, std::string>& index_word, const size_t textures, const size_t normals) // Face words without relative indices
+	{
+		for( auto& [index, word] : index_word )
+		{
+			auto text = std::to_string(index + 1);
+
+			auto slash = word.find('/');
+
+			for( size_t part = 1; slash != std::string::npos && part < 3; part++ )
+			{
+				const auto next = word.find('/', slash + 1);
+
+				const auto item = word.substr(slash + 1, next == std::string::npos ? std::string::npos : next - slash - 1);
+
+				text += '/';
+
+				if( !item.empty() && item[0] == '-' )
+					text += std::to_string(std::atoll(item.c_str()) + static_cast<long long>(part == 1 ? textures : normals) + 1);
+				else
+					text += item;
+
+				slash = next;
+			}
+
+			word = std::move(text);
+		}
+	}
+
+	inline void transition(const State& from, const State& to, const char* ending, std::string& text) // Statements for the o, g and s changes between two faces
+	{
+		static const char* const unset[] = {"", "g default", "s off"};
+
+		for( size_t index = 0; index < to.size(); index++ )
+		{
+			if( from[index] == to[index] ) continue;
+
+			const auto* line = to[index].empty() ? unset[index] : to[index].c_str();
+
+			if( *line == '\0' ) continue;
+
+			text += line;
+			text += ending;
+		}
+	}
+
+	inline bool triangulate(const char* line, const std::vector<Index>& indices, const std::vector<Point>& vertex, const size_t vertices, Count& count, std::string& face)
+	{
+		std::map<size_t, std::string> index_word;
+
+		std::vector<Point> polygon;
+
+		if( !gather(line, indices, vertex, vertices, count, index_word, polygon) )
+			return false;
+
+		return format(triangulate(polygon), index_word, count, face);
+	}
+
+	inline char* triangulate(char* line, const std::vector<Index>& indices, std::vector<Point>& vertex, Count& count)
+	{
+		std::string face;
+
+		if( !triangulate(line, indices, vertex, vertex.size(), count, face) )
+			return nullptr;
+
+		std::copy(face.begin(), face.end(), line);
+
+		line[face.size()] = '\0';
+
+		return line;
+	}
+
+	//-------------------------------------------------------------------------------------------------------
+
+	enum class TurnDirection
+	{
+		Right  = 1,
+		Left   = -1,
+		NoTurn = 0
+	};
+
+	inline Point operator-(const Point& u, const Point& v)
+	{
+		return {u.x - v.x , u.y - v.y , u.z - v.z};
+	}
+
+	inline Point operator/(const Point& u, const Real div)
+	{
+		if( div == 0 ) return {0 , 0 , 0};
+
+		return {u.x / div , u.y / div , u.z / div};
+	}
+
+	inline bool operator==(const Point& u, const Point& v)
+	{
+		if( fabs(u.x - v.x) > epsilon ) return false;
+		if( fabs(u.y - v.y) > epsilon ) return false;
+		if( fabs(u.z - v.z) > epsilon ) return false;
+
+		return true;
+	}
+
+	inline Point cross(const Point& u, const Point& v)
+	{
+		return {u.y * v.z - u.z * v.y , u.z * v.x - u.x * v.z , u.x * v.y - u.y * v.x};
+	}
+
+	inline Real dot(const Point& u, const Point& v)
+	{
+		return u.x * v.x + u.y * v.y + u.z * v.z;
+	}
+
+	inline Real length(const Point& u)
+	{
+		return std::sqrt(u.x * u.x + u.y * u.y + u.z * u.z);
+	}
+
+	inline Point normalize(const Point& point)
+	{
+		return point / obj::length(point);
+	}
+
+	inline bool encode(const std::vector<Triangle>& triangles, const Output output, Count& count, std::string& face)
+	{
+		face.clear();
+
+		if( triangles.empty() )
+			return false;
+
+		for( const auto& triangle : triangles )
+		{
+			if( output == Output::Stl )
+			{
+				const auto n = normalize(cross(triangle.p1 - triangle.p0, triangle.p2 - triangle.p0));
+
+				for( const auto* point : {&n, &triangle.p0, &triangle.p1, &triangle.p2} )
+				{
+					little(face, static_cast<float>(point->x));
+					little(face, static_cast<float>(point->y));
+					little(face, static_cast<float>(point->z));
+				}
+
+				little(face, uint16_t(0));
+			}
+			else
+			{
+				face += static_cast<char>(3);
+
+				little(face, static_cast<uint32_t>(triangle.p0.i));
+				little(face, static_cast<uint32_t>(triangle.p1.i));
+				little(face, static_cast<uint32_t>(triangle.p2.i));
+			}
+
+			count.triangles.second++;
+		}
+
+		return true;
+	}
+
+	inline TurnDirection turn(const Point& p, const Point& u, const Point& n, const Point& q)
+	{
+		const auto v = cross(q - p, u);
+
+		const auto dot = obj::dot(v, n);
+
+		// dot is |q - p| * sin(angle), short edges of finely sampled outlines need a threshold that shrinks with them
+
+		const auto limit = 0.001 * std::min(1.0, static_cast<double>(length(q - p)));
+
+		if( dot > +limit ) return TurnDirection::Right;
+		if( dot < -limit ) return TurnDirection::Left;
+
+		return TurnDirection::NoTurn;
+	}
+
+	inline Real triangleAreaSquared(const Point& a, const Point& b, const Point& c)
+	{
+		const auto cross = obj::cross(b - a, c - a);
+
+		return (cross.x * cross.x + cross.y * cross.y + cross.z * cross.z) / 4;
+	}
+
+	//-------------------------------------------------------------------------------------------------------
+
+	inline Point normal(const std::vector<Point>& polygon) //Newell's method
+	{
+		Point normal;
+
+		const auto n = polygon.size();
+
+		if( n < 3 ) return normal;
+
+		for( size_t index = 0; index < n; index++ )
+		{
+			const Point& item = polygon[index % n];
+			const Point& next = polygon[(index + 1) % n];
+
+			normal.x += (next.y - item.y) * (next.z + item.z);
+			normal.y += (next.z - item.z) * (next.x + item.x);
+			normal.z += (next.x - item.x) * (next.y + item.y);
+		}
+
+		return normalize(normal);
+	}
+
+	inline bool clockwiseOriented(const std::vector<Point>& polygon, const Point& normal)
+	{
+		const auto n = polygon.size();
+
+		if( n < 3 ) return false;
+
+		double orientationSum(0.0); // Twice the signed area along the normal, deep concave corners can not outweigh it
+
+		const auto& origin = polygon[0];
+
+		for( size_t index = 1; index + 1 < n; index++ )
+		{
+			const auto cross = obj::cross(polygon[index] - origin, polygon[index + 1] - origin);
+
+			orientationSum += dot(cross, normal);
+		}
+
+		return orientationSum < 0.0;
+	}
+
+	inline bool convex(const std::vector<Point>& polygon, const Point& normal) // No corner turns against the signed area, so a fan can not fold over
+	{
+		const auto n = polygon.size();
+
+		if( n < 3 ) return false;
+
+		if( n == 3 ) return true;
+
+		const auto clockwise = clockwiseOriented(polygon, normal);
+
+		for( size_t index = 0; index < n; index++ )
+		{
+			const auto& prev = polygon[(index - 1 + n) % n];
+			const auto& item = polygon[index % n];
+			const auto& next = polygon[(index + 1) % n];
+
+			const auto turn = dot(cross(item - prev, next - item), normal);
+
+			if( clockwise ? turn > 0.0 : turn < 0.0 )
+				return false;
+		}
+
+		return true;
+	}
+
+	inline void makeClockwiseOrientation(std::vector<Point>& polygon, const Point& normal)
+	{
+		if( polygon.size() < 3 ) return;
+
+		if( !clockwiseOriented(polygon, normal) )
+			polygon = {polygon.rbegin() , polygon.rend()};
+	}
+
+	inline bool pointInsideOrEdgeTriangle(const Point& a, const Point& b, const Point& c, const Point& p, bool& edge)
+	{
+		static double zero = std::numeric_limits<double>::epsilon();
+
+		// Initialize edge to false
+		edge = false;
+
+		// Vectors from point p to vertices of the triangle
+		const auto v0 = c - a;
+		const auto v1 = b - a;
+		const auto v2 = p - a;
+
+		const auto dot00 = dot(v0, v0);
+		const auto dot01 = dot(v0, v1);
+		const auto dot02 = dot(v0, v2);
+		const auto dot11 = dot(v1, v1);
+		const auto dot12 = dot(v1, v2);
+
+		// Check for degenerate triangle
+		const auto denom = dot00 * dot11 - dot01 * dot01;
+
+		if( std::abs(denom) < zero )
+		{
+			// The triangle is degenerate (i.e., has no area)
+			return false;
+		}
+
+		// Compute barycentric coordinates
+		const auto invDenom = 1.0 / denom;
+
+		const auto u = (dot11 * dot02 - dot01 * dot12) * invDenom;
+		const auto v = (dot00 * dot12 - dot01 * dot02) * invDenom;
+
+		// Check for edge condition
+		if( std::abs(u) < zero || std::abs(v) < zero || std::abs(u + v - 1) < zero )
+			edge = true;
+
+		// Check if point is inside the triangle (including edges)
+		return (u >= 0.0) && (v >= 0.0) && (u + v < 1.0);
+	}
+
+	inline bool pointOnDiagonal(const Point& a, const Point& c, const Point& p) // Cutting a-c would split the polygon at p
+	{
+		constexpr double tolerance = 1e-5;
+
+		const auto d = c - a;
+		const auto v = p - a;
+
+		const auto dd = dot(d, d);
+
+		if( dd <= 0.0 ) return false;
+
+		const auto t = dot(v, d) / dd;
+
+		if( t <= tolerance || t >= 1.0 - tolerance ) return false;
+
+		const auto off = cross(v, d);
+
+		return dot(off, off) / dd <= tolerance * tolerance * dd;
+	}
+
+	inline void removeConsecutiveEqualItems(std::vector<Point>& list)
+	{
+		const auto n = list.size();
+
+		const std::vector copy(std::move(list));
+
+		list.clear();
+
+		for( size_t index = 0; index < n; index++ )
+		{
+			const Point& item = copy[index % n];
+			const Point& next = copy[(index + 1) % n];
+
+			if( item.i == next.i ) continue;
+
+			list.emplace_back(item);
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------------------
+
+	inline bool isEar(const int index, const std::vector<Point>& polygon, const Point& normal)
+	{
+		const auto n = polygon.size();
+
+		if( n < 3 ) return false;
+
+		if( n == 3 ) return true;
+
+		bool edge(false);
+
+		const auto prevIndex = (index - 1 + n) % n;
+		const auto itemIndex = index % n;
+		const auto nextIndex = (index + 1) % n;
+
+		const Point& prev = polygon[prevIndex];
+		const Point& item = polygon[itemIndex];
+		const Point& next = polygon[nextIndex];
+
+		const auto u = normalize(item - prev);
+
+		if( turn(prev, u, normal, next) != TurnDirection::Right )
+			return false;
+
+		for( size_t i = 0; i < polygon.size(); i++ )
+		{
+			if( i == prevIndex ) continue;
+			if( i == itemIndex ) continue;
+			if( i == nextIndex ) continue;
+
+			if( pointInsideOrEdgeTriangle(prev, item, next, polygon[i], edge) )
+				return false;
+
+			if( pointOnDiagonal(prev, next, polygon[i]) )
+				return false;
+		}
+
+		return true;
+	}
+
+	inline int getBiggestEar(const std::vector<Point>& polygon, const Point& normal)
+	{
+		const auto n = static_cast<int>(polygon.size());
+
+		if( n == 3 ) return 0;
+
+		if( n == 0 ) return -1;
+
+		int maxIndex(-1);
+
+		double maxArea(DBL_MIN);
+
+		for( int index = 0; index < n; index++ )
+		{
+			if( isEar(index, polygon, normal) )
+			{
+				const Point& prev = polygon[(index - 1 + n) % n];
+				const Point& item = polygon[index % n];
+				const Point& next = polygon[(index + 1) % n];
+
+				const auto area = triangleAreaSquared(prev, item, next);
+
+				if( area > maxArea )
+				{
+					maxIndex = index;
+
+					maxArea = area;
+				}
+			}
+		}
+
+		return maxIndex;
+	}
+
+	inline int getOverlappingEar(const std::vector<Point>& polygon, const Point& normal)
+	{
+		const auto n = static_cast<int>(polygon.size());
+
+		if( n == 3 ) return 0;
+
+		if( n == 0 ) return -1;
+
+		for( int index = 0; index < n; index++ )
+		{
+			const Point& prev = polygon[(index - 1 + n) % n];
+			const Point& item = polygon[index % n];
+			const Point& next = polygon[(index + 1) % n];
+
+			const auto u = normalize(item - prev);
+
+			if( turn(prev, u, normal, next) != TurnDirection::NoTurn )
+				continue;
+
+			const auto v = normalize(next - item);
+
+			if( dot(u, v) < 0.0 ) //Opposite direction -> ear
+				return index;
+		}
+
+		return -1;
+	}
+
+	//-------------------------------------------------------------------------------------------------------
+
+	inline std::vector<Triangle> fanTriangulation(std::vector<Point>& polygon)
+	{
+		std::vector<Triangle> triangles;
+
+		for( size_t index = 1; index < polygon.size() - 1; ++index )
+			triangles.emplace_back(polygon[0], polygon[index], polygon[index + 1]);
+
+		return triangles;
+	}
+
+	inline std::vector<Triangle> cutTriangulation(std::vector<Point>& polygon, const Point& normal)
+	{
+		std::vector<Triangle> triangles;
+
+		makeClockwiseOrientation(polygon, normal);
+
+		while( !polygon.empty() )
+		{
+			int index = getBiggestEar(polygon, normal);
+
+			if( index == -1 )
+				index = getOverlappingEar(polygon, normal);
+
+			if( index == -1 )
+				return {};
+
+			const auto n = polygon.size();
+
+			const Point& prev = polygon[(index - 1 + n) % n];
+			const Point& item = polygon[index % n];
+			const Point& next = polygon[(index + 1) % n];
+
+			triangles.emplace_back(prev, item, next);
+
+			polygon.erase(polygon.begin() + index);
+
+			if( polygon.size() < 3 ) break;
+		}
+
+		return polygon.size() == 2 ? triangles : std::vector<Triangle>();
+	}
+
+	//-------------------------------------------------------------------------------------------------------
+
+	using Flat = std::array<double, 2>; // A corner projected on the polygon plane
+
+	inline void project(const std::vector<Point>& polygon, const Point& normal, std::vector<Flat>& flat) // Counter-clockwise seen along the normal
+	{
+		const auto ax = std::fabs(normal.x);
+		const auto ay = std::fabs(normal.y);
+		const auto az = std::fabs(normal.z);
+
+		flat.resize(polygon.size());
+
+		for( size_t index = 0; index < polygon.size(); index++ ) // The dominant axis is dropped, the other two keep the handedness (normal() points away from a counter-clockwise view)
+		{
+			const Point& p = polygon[index];
+
+			if( az >= ax && az >= ay )
+				flat[index] = normal.z < 0.0f ? Flat{p.x, p.y} : Flat{p.y, p.x};
+			else if( ax >= ay )
+				flat[index] = normal.x < 0.0f ? Flat{p.y, p.z} : Flat{p.z, p.y};
+			else
+				flat[index] = normal.y < 0.0f ? Flat{p.z, p.x} : Flat{p.x, p.z};
+		}
+	}
+
+	inline double orient(const Flat& a, const Flat& b, const Flat& c) // Positive when a, b, c turn counter-clockwise
+	{
+		return (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+	}
+
+	inline bool inside(const Flat& a, const Flat& b, const Flat& c, const Flat& p) // In the counter-clockwise triangle or on its edges
+	{
+		return orient(a, b, p) >= 0.0 && orient(b, c, p) >= 0.0 && orient(c, a, p) >= 0.0;
+	}
+
+	inline std::vector<Triangle> quadTriangulation(const std::vector<Point>& polygon) // Four corners, split on the diagonal through the reflex corner
+	{
+		const Point& p0 = polygon[0];
+		const Point& p1 = polygon[1];
+		const Point& p2 = polygon[2];
+		const Point& p3 = polygon[3];
+
+		const auto n = cross(p2 - p0, p3 - p1); // Twice the area vector, no need to normalize
+
+		const auto reflex = [&](const Point& prev, const Point& item, const Point& next) { return dot(cross(item - prev, next - item), n) < 0.0; };
+
+		std::vector<Triangle> triangles;
+
+		if( reflex(p0, p1, p2) )
+			triangles = {Triangle(p1, p2, p3), Triangle(p1, p3, p0)};
+		else if( reflex(p2, p3, p0) )
+			triangles = {Triangle(p3, p0, p1), Triangle(p3, p1, p2)};
+		else
+			triangles = {Triangle(p0, p1, p2), Triangle(p0, p2, p3)}; // Convex, reflex p0 or p2, or not simple
+
+		return triangles;
+	}
+
+	inline std::vector<Triangle> earClipping(const std::vector<Point>& polygon, const Point& normal, const bool grid) // Empty when no ear is left
+	{
+		const auto n = polygon.size();
+
+		std::vector<Flat> flat;
+
+		project(polygon, normal, flat);
+
+		std::vector<size_t> prev(n), next(n);
+
+		for( size_t index = 0; index < n; index++ )
+		{
+			prev[index] = (index + n - 1) % n;
+			next[index] = (index + 1) % n;
+		}
+
+		// Only reflex corners can be inside an ear, and clipping never makes a corner reflex
+
+		std::vector<char> reflex(n);
+		std::vector<char> removed(n, 0);
+
+		std::vector<size_t> reflexes;
+
+		const auto update = [&](const size_t index) { reflex[index] = orient(flat[prev[index]], flat[index], flat[next[index]]) <= 0.0; };
+
+		for( size_t index = 0; index < n; index++ )
+		{
+			update(index);
+
+			if( reflex[index] ) reflexes.push_back(index);
+		}
+
+		// Grid of the reflex corners, the ear test then only visits the cells under the ear
+
+		Flat low = {DBL_MAX, DBL_MAX}, high = {-DBL_MAX, -DBL_MAX};
+
+		size_t cells(1);
+
+		std::vector<size_t> start, cell;
+
+		if( grid && !reflexes.empty() )
+		{
+			for( const auto index : reflexes )
+			{
+				low  = {std::min(low[0], flat[index][0]), std::min(low[1], flat[index][1])};
+				high = {std::max(high[0], flat[index][0]), std::max(high[1], flat[index][1])};
+			}
+
+			cells = std::max<size_t>(1, static_cast<size_t>(std::sqrt(static_cast<double>(reflexes.size()))));
+
+			start.assign(cells * cells + 1, 0);
+			cell.resize(reflexes.size());
+		}
+
+		const auto column = [&](const double value, const size_t axis)
+		{
+			const auto size = high[axis] - low[axis];
+
+			if( size <= 0.0 ) return size_t(0);
+
+			return std::min(cells - 1, static_cast<size_t>(std::max(0.0, (value - low[axis]) / size * static_cast<double>(cells))));
+		};
+
+		if( !start.empty() )
+		{
+			for( const auto index : reflexes )
+				start[column(flat[index][1], 1) * cells + column(flat[index][0], 0) + 1]++;
+
+			for( size_t k = 1; k < start.size(); k++ )
+				start[k] += start[k - 1];
+
+			auto fill = start;
+
+			for( const auto index : reflexes )
+				cell[fill[column(flat[index][1], 1) * cells + column(flat[index][0], 0)]++] = index;
+		}
+
+		const auto blocked = [&](const size_t a, const size_t b, const size_t c, const size_t index)
+		{
+			if( removed[index] || !reflex[index] || index == a || index == b || index == c ) return false;
+
+			return inside(flat[a], flat[b], flat[c], flat[index]);
+		};
+
+		const auto ear = [&](const size_t b)
+		{
+			const auto a = prev[b];
+			const auto c = next[b];
+
+			const auto turn = orient(flat[a], flat[b], flat[c]);
+
+			if( turn < 0.0 ) return false;
+
+			if( turn == 0.0 ) return true; // Straight or a spike, the triangle has no area
+
+			if( start.empty() )
+			{
+				for( const auto index : reflexes )
+				{
+					if( blocked(a, b, c, index) ) return false;
+				}
+
+				return true;
+			}
+
+			const auto x0 = column(std::min({flat[a][0], flat[b][0], flat[c][0]}), 0);
+			const auto x1 = column(std::max({flat[a][0], flat[b][0], flat[c][0]}), 0);
+			const auto y0 = column(std::min({flat[a][1], flat[b][1], flat[c][1]}), 1);
+			const auto y1 = column(std::max({flat[a][1], flat[b][1], flat[c][1]}), 1);
+
+			for( auto y = y0; y <= y1; y++ )
+			{
+				for( auto x = x0; x <= x1; x++ )
+				{
+					for( auto k = start[y * cells + x]; k < start[y * cells + x + 1]; k++ )
+					{
+						if( blocked(a, b, c, cell[k]) ) return false;
+					}
+				}
+			}
+
+			return true;
+		};
+
+		std::vector<Triangle> triangles;
+
+		triangles.reserve(n - 2);
+
+		size_t item(0), remaining(n), misses(0);
+
+		while( remaining > 3 )
+		{
+			if( !ear(item) )
+			{
+				item = next[item];
+
+				if( ++misses == remaining ) return {}; // A full turn without an ear
+
+				continue;
+			}
+
+			const auto a = prev[item];
+			const auto c = next[item];
+
+			triangles.emplace_back(polygon[a], polygon[item], polygon[c]);
+
+			removed[item] = 1;
+
+			next[a] = c;
+			prev[c] = a;
+
+			remaining--;
+
+			if( reflex[a] ) update(a);
+			if( reflex[c] ) update(c);
+
+			item   = c;
+			misses = 0;
+		}
+
+		triangles.emplace_back(polygon[prev[item]], polygon[item], polygon[next[item]]);
+
+		return triangles;
+	}
+
+	inline std::vector<Triangle> clipTriangulation(const std::vector<Point>& polygon, const Point& normal) // First ear found, O(n^2)
+	{
+		return earClipping(polygon, normal, false);
+	}
+
+	inline std::vector<Triangle> gridTriangulation(const std::vector<Point>& polygon, const Point& normal) // First ear found, reflex corners in a grid
+	{
+		return earClipping(polygon, normal, true);
+	}
+
+	inline bool monotone(std::vector<Flat>& flat, size_t& low, size_t& high) // Turned a quarter when monotone along y and not x
+	{
+		const auto n = flat.size();
+
+		for( size_t axis = 0; axis < 2; axis++ ) // Keys compared lexicographically, ties broken by the other coordinate
+		{
+			if( axis == 1 )
+			{
+				for( auto& p : flat )
+					p = {p[1], -p[0]};
+			}
+
+			size_t minima(0);
+
+			bool equal(false);
+
+			low = high = 0;
+
+			for( size_t index = 0; index < n; index++ )
+			{
+				const auto& p = flat[(index + n - 1) % n];
+				const auto& q = flat[(index + 1) % n];
+
+				equal |= flat[index] == q;
+
+				if( flat[index] < p && flat[index] < q ) minima++;
+
+				if( flat[index] < flat[low] ) low = index;
+				if( flat[high] < flat[index] ) high = index;
+			}
+
+			if( !equal && minima == 1 ) return true;
+		}
+
+		return false;
+	}
+
+	inline bool monotone(const std::vector<Point>& polygon, const Point& normal)
+	{
+		std::vector<Flat> flat;
+
+		project(polygon, normal, flat);
+
+		size_t low, high;
+
+		return monotone(flat, low, high);
+	}
+
+	inline std::vector<Triangle> sweepTriangulation(const std::vector<Point>& polygon, const Point& normal) // Monotone polygons in O(n), empty for others
+	{
+		const auto n = polygon.size();
+
+		std::vector<Flat> flat;
+
+		project(polygon, normal, flat);
+
+		size_t low, high;
+
+		if( !monotone(flat, low, high) ) return {};
+
+		const auto less = [&](const size_t a, const size_t b) { return flat[a] < flat[b]; };
+
+		// Both chains from the lowest to the highest corner are sorted, merge them. Chain 0 runs forward, below the interior
+
+		std::vector<std::pair<size_t, int>> order;
+
+		order.reserve(n);
+
+		size_t forward = (low + 1) % n, backward = (low + n - 1) % n;
+
+		order.emplace_back(low, 0);
+
+		while( forward != high || backward != high )
+		{
+			if( backward == high || (forward != high && less(forward, backward)) )
+			{
+				order.emplace_back(forward, 0);
+
+				forward = (forward + 1) % n;
+			}
+			else
+			{
+				order.emplace_back(backward, 1);
 
-		list.clear();
+				backward = (backward + n - 1) % n;
+			}
+		}
 
-		for( size_t index = 0; index < n; index++ )
+		order.emplace_back(high, 1);
+
+		std::vector<Triangle> triangles;
+
+		triangles.reserve(n - 2);
+
+		const auto emit = [&](const size_t a, const size_t b, const size_t c) { triangles.emplace_back(polygon[a], polygon[b], polygon[c]); };
+
+		const auto across = [&](const size_t item, const int chain, const std::vector<std::pair<size_t, int>>& stack) // Fan to the other chain
 		{
-			const Point& item = copy[index % n];
-			const Point& next = copy[(index + 1) % n];
+			for( size_t k = 0; k + 1 < stack.size(); k++ )
+			{
+				if( chain == 0 )
+					emit(item, stack[k + 1].first, stack[k].first);
+				else
+					emit(item, stack[k].first, stack[k + 1].first);
+			}
+		};
 
-			if( item.i == next.i ) continue;
+		std::vector<std::pair<size_t, int>> stack = {order[0], order[1]};
 
-			list.emplace_back(item);
+		for( size_t j = 2; j + 1 < n; j++ )
+		{
+			const auto [item, chain] = order[j];
+
+			if( chain != stack.back().second )
+			{
+				across(item, chain, stack);
+
+				stack = {stack.back(), order[j]};
+
+				continue;
+			}
+
+			auto last = stack.back();
+
+			stack.pop_back();
+
+			while( !stack.empty() )
+			{
+				const auto top = stack.back().first;
+
+				const auto turn = chain == 0 ? orient(flat[top], flat[last.first], flat[item]) : orient(flat[item], flat[last.first], flat[top]);
+
+				if( turn <= 0.0 ) break;
+
+				if( chain == 0 )
+					emit(top, last.first, item);
+				else
+					emit(item, last.first, top);
+
+				last = stack.back();
+
+				stack.pop_back();
+			}
+
+			stack.push_back(last);
+			stack.push_back(order[j]);
 		}
+
+		across(order[n - 1].first, 1 - stack.back().second, stack);
+
+		if( triangles.size() != n - 2 ) return {};
+
+		return triangles;
 	}
 
-	//-------------------------------------------------------------------------------------------------------
+	inline int side(const Flat& a, const Flat& b, const Flat& c) // Of c to the line a-b, 1 left, -1 right, 0 when the angle at a is within epsilon
+	{
+		const auto o = orient(a, b, c);
 
-	inline bool isEar(const int index, const std::vector<Point>& polygon, const Point& normal)
+		const auto ab = (b[0] - a[0]) * (b[0] - a[0]) + (b[1] - a[1]) * (b[1] - a[1]);
+		const auto ac = (c[0] - a[0]) * (c[0] - a[0]) + (c[1] - a[1]) * (c[1] - a[1]);
+
+		const auto e = static_cast<double>(epsilon);
+
+		if( o * o <= e * e * ab * ac ) return 0;
+
+		return o > 0.0 ? 1 : -1;
+	}
+
+	inline bool within(const std::vector<Flat>& flat, const size_t corner, const Flat& p) // Strictly inside the angle at the corner
 	{
-		const auto n = polygon.size();
+		const auto n = flat.size();
 
-		if( n < 3 ) return false;
+		const Flat& prev = flat[(corner + n - 1) % n];
+		const Flat& item = flat[corner];
+		const Flat& next = flat[(corner + 1) % n];
 
-		if( n == 3 ) return true;
+		if( side(prev, item, next) >= 0 )
+			return side(prev, item, p) > 0 && side(item, next, p) > 0;
 
-		bool edge(false);
+		return side(prev, item, p) > 0 || side(item, next, p) > 0;
+	}
 
-		const auto prevIndex = (index - 1 + n) % n;
-		const auto itemIndex = index % n;
-		const auto nextIndex = (index + 1) % n;
+	inline bool diagonal(const std::vector<Flat>& flat, const size_t a, const size_t b) // Inside the polygon, touching no edge or corner besides its own two
+	{
+		const auto n = flat.size();
 
-		const Point& prev = polygon[prevIndex];
-		const Point& item = polygon[itemIndex];
-		const Point& next = polygon[nextIndex];
+		if( a == b || (a + 1) % n == b || (b + 1) % n == a ) return false;
 
-		const auto u = normalize(item - prev);
+		if( !within(flat, a, flat[b]) || !within(flat, b, flat[a]) ) return false;
 
-		if( turn(prev, u, normal, next) != TurnDirection::Right )
-			return false;
+		const Flat& p = flat[a];
+		const Flat& q = flat[b];
 
-		for( size_t i = 0; i < polygon.size(); i++ )
+		const Flat low  = {std::min(p[0], q[0]), std::min(p[1], q[1])};
+		const Flat high = {std::max(p[0], q[0]), std::max(p[1], q[1])};
+
+		for( size_t k = 0; k < n; k++ )
 		{
-			if( i == prevIndex ) continue;
-			if( i == itemIndex ) continue;
-			if( i == nextIndex ) continue;
+			const auto l = (k + 1) % n;
 
-			if( pointInsideOrEdgeTriangle(prev, item, next, polygon[i], edge) )
-				return false;
+			const Flat& r = flat[k];
+			const Flat& s = flat[l];
+
+			if( std::max(r[0], s[0]) < low[0] || std::min(r[0], s[0]) > high[0] || std::max(r[1], s[1]) < low[1] || std::min(r[1], s[1]) > high[1] )
+				continue;
+
+			if( k != a && k != b && r[0] >= low[0] && r[0] <= high[0] && r[1] >= low[1] && r[1] <= high[1] && side(p, q, r) == 0 )
+				return false; // A corner on the diagonal
+
+			if( k == a || k == b || l == a || l == b )
+				continue;
+
+			const auto o1 = side(p, q, r);
+			const auto o2 = side(p, q, s);
+
+			if( o1 * o2 > 0 )
+				continue;
+
+			const auto o3 = side(r, s, p);
+			const auto o4 = side(r, s, q);
+
+			if( o3 * o4 > 0 )
+				continue;
+
+			return false; // Crossing or touching
 		}
 
 		return true;
 	}
 
-	inline int getBiggestEar(const std::vector<Point>& polygon, const Point& normal)
+	inline size_t visible(const std::vector<Flat>& flat, const size_t a, const Flat& direction, const size_t target) // A corner seen from a along the ray, the target when nothing is in front of it, n for none
 	{
-		const auto n = static_cast<int>(polygon.size());
-
-		if( n == 3 ) return 0;
+		const auto n = flat.size();
 
-		if( n == 0 ) return -1;
+		const Flat& p = flat[a];
 
-		int maxIndex(-1);
+		double nearest(DBL_MAX);
 
-		double maxArea(DBL_MIN);
+		size_t edge(n);
 
-		for( int index = 0; index < n; index++ )
+		for( size_t k = 0; k < n; k++ ) // First edge the ray meets
 		{
-			if( isEar(index, polygon, normal) )
-			{
-				const Point& prev = polygon[(index - 1 + n) % n];
-				const Point& item = polygon[index % n];
-				const Point& next = polygon[(index + 1) % n];
+			const auto l = (k + 1) % n;
 
-				const auto area = triangleAreaSquared(prev, item, next);
+			if( k == a || l == a ) continue;
 
-				if( area > maxArea )
-				{
-					maxIndex = index;
+			const Flat e = {flat[l][0] - flat[k][0], flat[l][1] - flat[k][1]};
+			const Flat w = {flat[k][0] - p[0], flat[k][1] - p[1]};
 
-					maxArea = area;
-				}
+			const auto denominator = direction[0] * e[1] - direction[1] * e[0];
+
+			if( denominator == 0.0 ) continue;
+
+			const auto t = (w[0] * e[1] - w[1] * e[0]) / denominator;
+			const auto u = (w[0] * direction[1] - w[1] * direction[0]) / denominator;
+
+			if( t > 0.0 && u >= 0.0 && u <= 1.0 && t < nearest )
+			{
+				nearest = t;
+				edge    = k;
 			}
 		}
 
-		return maxIndex;
-	}
+		if( target < n && nearest >= 1.0 ) return target;
 
-	inline int getOverlappingEar(const std::vector<Point>& polygon, const Point& normal)
-	{
-		const auto n = static_cast<int>(polygon.size());
+		if( edge == n ) return n;
 
-		if( n == 3 ) return 0;
+		const auto cosine = [&](const size_t corner) // Of the angle between the ray and the corner
+		{
+			const Flat v = {flat[corner][0] - p[0], flat[corner][1] - p[1]};
 
-		if( n == 0 ) return -1;
+			const auto length = std::sqrt(v[0] * v[0] + v[1] * v[1]);
 
-		for( int index = 0; index < n; index++ )
+			return length == 0.0 ? -1.0 : (v[0] * direction[0] + v[1] * direction[1]) / length;
+		};
+
+		const Flat hit = {p[0] + nearest * direction[0], p[1] + nearest * direction[1]};
+
+		auto corner = cosine(edge) >= cosine((edge + 1) % n) ? edge : (edge + 1) % n;
+
+		const Flat end = flat[corner];
+
+		const Flat low  = {std::min({p[0], hit[0], end[0]}), std::min({p[1], hit[1], end[1]})};
+		const Flat high = {std::max({p[0], hit[0], end[0]}), std::max({p[1], hit[1], end[1]})};
+
+		for( size_t k = 0; k < n; k++ ) // Reflex corners in the triangle between the ray and that end hide it, the one closest to the ray is seen
 		{
-			const Point& prev = polygon[(index - 1 + n) % n];
-			const Point& item = polygon[index % n];
-			const Point& next = polygon[(index + 1) % n];
+			const Flat& q = flat[k];
 
-			const auto u = normalize(item - prev);
+			if( q[0] < low[0] || q[0] > high[0] || q[1] < low[1] || q[1] > high[1] || k == a || k == corner ) continue;
 
-			if( turn(prev, u, normal, next) != TurnDirection::NoTurn )
-				continue;
+			if( !inside(p, hit, end, q) && !inside(p, end, hit, q) ) continue;
 
-			const auto v = normalize(next - item);
+			if( orient(flat[(k + n - 1) % n], q, flat[(k + 1) % n]) > 0.0 ) continue;
 
-			if( dot(u, v) < 0.0 ) //Opposite direction -> ear
-				return index;
+			if( cosine(k) > cosine(corner) )
+				corner = k;
 		}
 
-		return -1;
+		return corner;
 	}
 
-	//-------------------------------------------------------------------------------------------------------
-
-	inline std::vector<Triangle> fanTriangulation(std::vector<Point>& polygon)
+	inline bool halve(const std::vector<Point>& polygon, const Point& normal, std::vector<Point>& first, std::vector<Point>& second) // Split on a diagonal into two pieces of similar size, false when none is found
 	{
-		std::vector<Triangle> triangles;
+		constexpr size_t TRIES   = 32; // Corners a diagonal is searched from, spread over the polygon
+		constexpr size_t TARGETS = 3;  // Corners each of them aims at, a half, a third and two thirds round the polygon
 
-		for( size_t index = 1; index < polygon.size() - 1; ++index )
-			triangles.emplace_back(polygon[0], polygon[index], polygon[index + 1]);
+		const size_t share[TARGETS] = {3, 2, 4}; // Sixths of the polygon between a corner and its target
 
-		return triangles;
-	}
+		constexpr double pi = 3.14159265358979323846; // M_PI needs _USE_MATH_DEFINES with MSVC
 
-	inline std::vector<Triangle> cutTriangulation(std::vector<Point>& polygon, const Point& normal)
-	{
-		std::vector<Triangle> triangles;
+		const auto n = polygon.size();
 
-		makeClockwiseOrientation(polygon, normal);
+		if( n < 6 ) return false;
 
-		while( !polygon.empty() )
+		std::vector<Flat> flat;
+
+		project(polygon, normal, flat);
+
+		size_t a(0), b(0), best(0);
+
+		const auto take = [&](const size_t from, const size_t corner)
 		{
-			int index = getBiggestEar(polygon, normal);
+			const auto size = std::min((corner + n - from) % n, (from + n - corner) % n);
 
-			if( index == -1 )
-				index = getOverlappingEar(polygon, normal);
+			if( size <= best || !diagonal(flat, from, corner) ) return;
 
-			if( index == -1 )
-				return {};
+			a    = from;
+			b    = corner;
+			best = size;
+		};
 
-			const auto n = polygon.size();
+		size_t from[TRIES];
 
-			const Point& prev = polygon[(index - 1 + n) % n];
-			const Point& item = polygon[index % n];
-			const Point& next = polygon[(index + 1) % n];
+		for( size_t attempt = 0; attempt < TRIES; attempt++ )
+		{
+			from[attempt] = attempt * n / TRIES;
 
-			triangles.emplace_back(prev, item, next);
+			for( size_t step = 0; step < std::max<size_t>(1, n / TRIES); step++ ) // A reflex corner close by sees further, if there is one
+			{
+				const auto k = (attempt * n / TRIES + step) % n;
 
-			polygon.erase(polygon.begin() + index);
+				if( orient(flat[(k + n - 1) % n], flat[k], flat[(k + 1) % n]) < 0.0 )
+				{
+					from[attempt] = k;
 
-			if( polygon.size() < 3 ) break;
+					break;
+				}
+			}
 		}
 
-		return polygon.size() == 2 ? triangles : std::vector<Triangle>();
+		for( size_t attempt = 0; attempt < TRIES && best < n / 4; attempt++ ) // Straight to the targets
+		{
+			for( size_t target = 0; target < TARGETS && best < n / 4; target++ )
+				take(from[attempt], (from[attempt] + n * share[target] / 6) % n);
+		}
+
+		for( size_t attempt = 0; attempt < TRIES && best < n / 4; attempt++ ) // Rays towards the targets in front and along the bisector, to the corner they see
+		{
+			const Flat& prev = flat[(from[attempt] + n - 1) % n];
+			const Flat& item = flat[from[attempt]];
+			const Flat& next = flat[(from[attempt] + 1) % n];
+
+			const auto start = std::atan2(next[1] - item[1], next[0] - item[0]); // The inside of the corner turns counter-clockwise from the next edge to the previous one
+
+			auto angle = std::atan2(prev[1] - item[1], prev[0] - item[0]) - start;
+
+			if( angle <= 0.0 ) angle += 2.0 * pi;
+
+			for( size_t ray = 0; ray <= TARGETS && best < n / 4; ray++ )
+			{
+				const auto to = ray < TARGETS ? (from[attempt] + n * share[ray] / 6) % n : n;
+
+				if( to < n && !within(flat, from[attempt], flat[to]) ) continue;
+
+				const auto direction = to < n ? Flat{flat[to][0] - item[0], flat[to][1] - item[1]} : Flat{std::cos(start + 0.5 * angle), std::sin(start + 0.5 * angle)};
+
+				const auto corner = visible(flat, from[attempt], direction, to);
+
+				if( corner < n ) take(from[attempt], corner);
+			}
+		}
+
+		if( best < std::max<size_t>(2, n / 16) ) return false; // Thin slices would take a level each
+
+		first.clear();
+		second.clear();
+
+		for( auto k = a; k != b; k = (k + 1) % n ) first.push_back(polygon[k]);
+		for( auto k = b; k != a; k = (k + 1) % n ) second.push_back(polygon[k]);
+
+		first.push_back(polygon[b]);
+		second.push_back(polygon[a]);
+
+		return true;
+	}
+
+	inline std::vector<std::vector<Point>> split(const std::vector<Point>& polygon, const Point& normal, const size_t corners) // Halved until the pieces have fewer corners or no diagonal is found
+	{
+		std::vector<std::vector<Point>> pieces, open(1, polygon);
+
+		std::vector<Point> first, second;
+
+		while( !open.empty() )
+		{
+			auto piece = std::move(open.back());
+
+			open.pop_back();
+
+			if( piece.size() >= corners && halve(piece, normal, first, second) )
+			{
+				open.push_back(std::move(second));
+				open.push_back(std::move(first));
+			}
+			else
+				pieces.push_back(std::move(piece));
+		}
+
+		return pieces;
 	}
 
+	//-------------------------------------------------------------------------------------------------------
+
 	inline std::vector<Triangle> triangulate(std::vector<Point>& polygon)
 	{
 		removeConsecutiveEqualItems(polygon);
@@ -976,16 +5128,137 @@ namespace obj
 		return convex(polygon, normal) ? fanTriangulation(polygon) : cutTriangulation(polygon, normal);
 	}
 
+	inline std::vector<Triangle> triangulate(std::vector<Point>& polygon, const Selection& selection) // The engine from the size and shape
+	{
+		removeConsecutiveEqualItems(polygon);
+
+		const auto n = polygon.size();
+
+		if( n < 3 ) return {};
+
+		if( n == 3 ) return {Triangle(polygon[0], polygon[1], polygon[2])};
+
+		if( n == 4 ) return quadTriangulation(polygon);
+
+		const auto normal = obj::normal(polygon);
+
+		if( convex(polygon, normal) ) return fanTriangulation(polygon);
+
+		if( n <= selection.cut ) return cutTriangulation(polygon, normal);
+
+		std::vector<Triangle> triangles;
+
+		if( selection.sweep != 0 && n >= selection.sweep )
+			triangles = sweepTriangulation(polygon, normal);
+
+		if( triangles.empty() )
+			triangles = selection.grid != 0 && n >= selection.grid ? gridTriangulation(polygon, normal) : clipTriangulation(polygon, normal);
+
+		if( triangles.empty() ) // Clipping gives up on some shapes that are not simple, the reference handles them
+			return cutTriangulation(polygon, normal);
+
+		return triangles;
+	}
+
 	//-------------------------------------------------------------------------------------------------------
 
+	inline uint64_t Triangulate::hash() const
+	{
+		auto result = contents;
+
+		result.add(settings());
+
+		return result.value;
+	}
+
+	inline bool Triangulate::uptodate(const std::string& source_obj, const std::string& target_obj) const
+	{
+		FILE* file = fopen(target_obj.c_str(), "rb");
+
+		if( file == nullptr ) return false;
+
+		std::string header(1024, '\0'); // The hash is within the first lines of an OBJ or PLY header, or the STL header text
+
+		header.resize(fread(&header[0], 1, header.size(), file));
+
+		fclose(file);
+
+		const auto at = header.find("Hash      : ");
+
+		unsigned long long stored(0);
+
+		if( at != std::string::npos )
+			sscanf(header.c_str() + at, "Hash      : %llx", &stored);
+
+		if( stored == 0 ) return false;
+
+		file = fopen(source_obj.c_str(), "rb");
+
+		if( file == nullptr ) return false;
+
+		std::vector<char> block(1 << 20);
+
+		Hash bytes;
+
+		size_t size(0);
+
+		while( (size = fread(block.data(), 1, block.size(), file)) > 0 )
+			bytes.add(block.data(), size);
+
+		bytes.add(settings());
+
+		const auto ok = ferror(file) == 0;
+
+		fclose(file);
+
+		return ok && bytes.value == stored;
+	}
+
 	inline bool Triangulate::write_header(const std::string& source_obj)
 	{
-		if( fseek(target, 0, SEEK_SET) != 0 ) return error();
+		if( seek(target, 0) != 0 ) return error();
+
+		const auto hashed = static_cast<unsigned long long>(count.empty() || !skipUnchanged ? 0 : hash());
+
+		if( outputFormat == Output::Stl ) // 80 byte text and the triangle count, both rewritten when done
+		{
+			char text[81] = {0};
+
+			snprintf(text, sizeof text, "TriangulateOBJ Hash      : %016llx %s", hashed, filename(source_obj).c_str());
+
+			std::string header(text);
+
+			header.resize(80, ' ');
+
+			little(header, static_cast<uint32_t>(writtenTriangles)); // fits() stops larger models
+
+			return fwrite(header.data(), 1, header.size(), target) == header.size() ? true : error();
+		}
+
+		if( outputFormat == Output::Ply ) // Fixed width counts, so the header keeps its size when rewritten
+		{
+			fprintf(target, "ply\n");
+			fprintf(target, "format binary_little_endian 1.0\n");
+			fprintf(target, "comment Triangulated by FalconCoding (https://github.com/StefanJohnsen) from %s\n", filename(source_obj).c_str());
+			fprintf(target, "comment Hash      : %016llx\n", hashed);
+			fprintf(target, "element vertex %012llu\n", static_cast<unsigned long long>(writtenVertices));
+			fprintf(target, "property float x\n");
+			fprintf(target, "property float y\n");
+			fprintf(target, "property float z\n");
+			fprintf(target, "element face %012llu\n", static_cast<unsigned long long>(writtenTriangles));
+			fprintf(target, "property list uchar uint vertex_indices\n");
+
+			if( chunking() ) fprintf(target, "property uint chunk\n");
+			fprintf(target, "end_header\n");
+
+			return true;
+		}
 
 		fprintf(target, "# Triangulated OBJ File\n");
 		fprintf(target, "# File Triangulated by FalconCoding (https://github.com/StefanJohnsen)\n");
 		fprintf(target, "\n");
 		fprintf(target, "# Original file name : %s\n", filename(source_obj).c_str());
+		fprintf(target, "#          Hash      : %016llx\n", hashed);
 		fprintf(target, "#          Vertices  : %zu\n", count.vertices);
 		fprintf(target, "#          Polygons  : %zu\n", count.polygons.first);
 		fprintf(target, "#          Triangles : %zu\n", count.triangles.first);
@@ -0,0 +1,372 @@
+/*
+  bench.cpp - Microbenchmarks for the parser and triangulation kernels in TriangulateOBJ.h
+
+  Copyright (c) 2023 FalconCoding
+
+  This software is released under the terms of the
+  GNU General Public License v3.0. Details and terms of this
+  license can be found at: https://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+/*
+  -[Possible command arguments]---------------------------------------------------------
+
+   TriangulateOBJ_bench                                     (all benchmarks, JSON to stdout)
+   TriangulateOBJ_bench --filter cutTriangulation/star      (only names containing the text)
+   TriangulateOBJ_bench --min-time 200 --json bench.json    (200 ms per measurement)
+   TriangulateOBJ_bench --store big.obj                     (converts big.obj with memory budgets from unlimited to 1M, faces/s)
+   TriangulateOBJ_bench --io big.obj                        (converts big.obj through stdio, a mapped target and io_uring, faces/s)
+
+  --------------------------------------------------------------------------------------
+*/
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+
+#include "shape.h"
+#include "TriangulateOBJ.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct Result
+{
+	std::string name;
+
+	size_t items      = 0; // Items processed per operation
+	size_t iterations = 0;
+
+	double ns = 0.0; // Nanoseconds per operation (median of the repetitions)
+};
+
+struct Options
+{
+	std::string filter;
+	std::string json;
+	std::string store; // Source for the memory budget sweep, the kernels are skipped
+	std::string io;    // Source for the I/O backends, the kernels are skipped
+
+	double minTime = 100.0; // Milliseconds per repetition
+
+	int repetitions = 5;
+};
+
+static volatile double sink;
+
+inline Result measure(const std::string& name, const size_t items, const Options& options, const std::function<double()>& op)
+{
+	using Nano = std::chrono::duration<double, std::nano>;
+
+	Result result;
+
+	result.name  = name;
+	result.items = items;
+
+	size_t iterations(1);
+
+	while( true ) // Grow the iteration count until one repetition lasts min-time
+	{
+		const auto start = Clock::now();
+
+		for( size_t i = 0; i < iterations; i++ )
+			sink = sink + op();
+
+		const auto elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+		if( elapsed >= options.minTime || iterations >= (size_t(1) << 30) )
+			break;
+
+		iterations = elapsed <= 0.0 ? iterations * 10 : std::max(iterations + 1, static_cast<size_t>(static_cast<double>(iterations) * options.minTime * 1.2 / elapsed));
+	}
+
+	std::vector<double> samples;
+
+	for( int r = 0; r < options.repetitions; r++ )
+	{
+		const auto start = Clock::now();
+
+		for( size_t i = 0; i < iterations; i++ )
+			sink = sink + op();
+
+		samples.push_back(Nano(Clock::now() - start).count() / static_cast<double>(iterations));
+	}
+
+	std::sort(samples.begin(), samples.end());
+
+	result.iterations = iterations;
+	result.ns         = samples[samples.size() / 2];
+
+	return result;
+}
+
+inline std::string numbers(const size_t count, const bool real)
+{
+	std::ostringstream text;
+
+	unsigned seed(12345);
+
+	for( size_t i = 0; i < count; i++ )
+	{
+		seed = seed * 1103515245u + 12345u;
+
+		const auto value = static_cast<int>(seed >> 8) % 2000000 - 1000000;
+
+		if( real ) // Thousandths, -0.5 is written -0.500 and -12.005 keeps its zeros
+			text << (value < 0 ? "-" : "") << std::abs(value) / 1000 << '.' << std::setw(3) << std::setfill('0') << std::abs(value) % 1000 << ' ';
+		else
+			text << value << ' ';
+	}
+
+	return text.str();
+}
+
+int main(int argc, char* argv[])
+{
+	Options options;
+
+	for( int i = 1; i < argc; i++ )
+	{
+		const std::string arg = argv[i];
+
+		if( arg == "--filter" && i + 1 < argc )
+			options.filter = argv[++i];
+		else if( arg == "--json" && i + 1 < argc )
+			options.json = argv[++i];
+		else if( arg == "--store" && i + 1 < argc )
+			options.store = argv[++i];
+		else if( arg == "--io" && i + 1 < argc )
+			options.io = argv[++i];
+		else if( arg == "--min-time" && i + 1 < argc )
+			options.minTime = std::atof(argv[++i]);
+		else if( arg == "--repetitions" && i + 1 < argc )
+			options.repetitions = std::max(1, std::atoi(argv[++i]));
+		else
+		{
+			std::cout << "Error argument: Unknown argument " << arg << std::endl;
+
+			return 1;
+		}
+	}
+
+	std::vector<Result> results;
+
+	const auto run = [&](const std::string& name, const size_t items, const std::function<double()>& op)
+	{
+		if( !options.filter.empty() && name.find(options.filter) == std::string::npos )
+			return;
+
+		results.push_back(measure(name, items, options, op));
+
+		std::cerr << name << std::endl;
+	};
+
+	if( !options.store.empty() ) // Whole conversions at each memory budget, the items are the faces of the source
+	{
+		const std::pair<const char*, size_t> budgets[] = {{"unlimited", 0}, {"1G", size_t(1) << 30}, {"256M", size_t(256) << 20}, {"64M", size_t(64) << 20}, {"16M", size_t(16) << 20}, {"4M", size_t(4) << 20}, {"1M", size_t(1) << 20}};
+
+		const auto target = options.store + ".bench.obj";
+
+		for( const auto& budget : budgets )
+		{
+			obj::Triangulate converter;
+
+			converter.budget(budget.second);
+
+			if( !converter.triangulate(options.store, target) ) return 1;
+
+			const auto faces = converter.metrics().polygons.first + converter.metrics().triangles.first;
+
+			run(std::string("convert/budget/") + budget.first, faces, [&]
+			{
+				return converter.triangulate(options.store, target) ? 1.0 : 0.0;
+			});
+		}
+
+		std::remove(target.c_str());
+	}
+	else if( !options.io.empty() ) // Whole conversions through each I/O backend, the items are the faces of the source
+	{
+		struct Backend
+		{
+			const char* name;
+
+			obj::Io io;
+
+			bool mapped;
+		};
+
+		const Backend backends[] = {{"stdio", obj::Io::Stdio, false}, {"mmap", obj::Io::Stdio, true}, {"uring", obj::Io::Uring, false}, {"uring+mmap", obj::Io::Uring, true}};
+
+		const auto target = options.io + ".bench.obj";
+
+		for( const auto& backend : backends )
+		{
+			obj::Triangulate converter;
+
+			converter.io(backend.io);
+			converter.map(backend.mapped);
+
+			if( !converter.triangulate(options.io, target) ) return 1;
+
+			const auto faces = converter.metrics().polygons.first + converter.metrics().triangles.first;
+
+			if( backend.io == obj::Io::Uring && converter.profile().ringReads == 0 ) // Not Linux, or io_uring not allowed
+			{
+				std::cerr << "convert/io/" << backend.name << " skipped, io_uring is not available" << std::endl;
+
+				continue;
+			}
+
+			run(std::string("convert/io/") + backend.name, faces, [&]
+			{
+				return converter.triangulate(options.io, target) ? 1.0 : 0.0;
+			});
+		}
+
+		std::remove(target.c_str());
+	}
+	else
+	{
+		constexpr size_t numberCount = 10'000;
+
+		const auto reals    = numbers(numberCount, true);
+		const auto integers = numbers(numberCount, false);
+
+		run("strtof", numberCount, [&]
+		{
+			const char* p = reals.c_str();
+
+			obj::Real value(0), sum(0);
+
+			while( obj::strtof(p, value, p) ) sum += value;
+
+			return static_cast<double>(sum);
+		});
+
+		run("strtoi", numberCount, [&]
+		{
+			const char* p = integers.c_str();
+
+			int value(0);
+
+			long long sum(0);
+
+			while( obj::strtoi(p, value, p) ) sum += value;
+
+			return static_cast<double>(sum);
+		});
+
+		const size_t sizes[] = {4, 8, 16, 64, 256, 1024};
+
+		for( const auto kind : shape::kinds )
+		{
+			for( const auto size : sizes )
+			{
+				const auto polygon = shape::make(kind, size);
+				const auto normal  = obj::normal(polygon);
+				const auto n       = polygon.size();
+
+				const auto suffix = "/" + shape::name(kind) + "/" + std::to_string(size);
+
+				run("normal" + suffix, n, [&]
+				{
+					return static_cast<double>(obj::normal(polygon).z);
+				});
+
+				run("convex" + suffix, n, [&]
+				{
+					return obj::convex(polygon, normal) ? 1.0 : 0.0;
+				});
+
+				run("isEar" + suffix, n, [&]
+				{
+					double ears(0.0);
+
+					for( size_t index = 0; index < n; index++ )
+						ears += obj::isEar(static_cast<int>(index), polygon, normal) ? 1.0 : 0.0;
+
+					return ears;
+				});
+
+				run("fanTriangulation" + suffix, n, [&] // Includes the polygon copy
+				{
+					auto copy = polygon;
+
+					return static_cast<double>(obj::fanTriangulation(copy).size());
+				});
+
+				run("cutTriangulation" + suffix, n, [&] // Includes the polygon copy
+				{
+					auto copy = polygon;
+
+					return static_cast<double>(obj::cutTriangulation(copy, normal).size());
+				});
+
+				run("clipTriangulation" + suffix, n, [&]
+				{
+					return static_cast<double>(obj::clipTriangulation(polygon, normal).size());
+				});
+
+				run("gridTriangulation" + suffix, n, [&]
+				{
+					return static_cast<double>(obj::gridTriangulation(polygon, normal).size());
+				});
+
+				if( obj::monotone(polygon, normal) )
+				{
+					run("sweepTriangulation" + suffix, n, [&]
+					{
+						return static_cast<double>(obj::sweepTriangulation(polygon, normal).size());
+					});
+				}
+			}
+		}
+	}
+
+	std::ostringstream json;
+
+	json << "{\n  \"benchmarks\": [\n";
+
+	for( size_t i = 0; i < results.size(); i++ )
+	{
+		const auto& result = results[i];
+
+		const auto itemsPerSecond = result.ns > 0.0 ? static_cast<double>(result.items) * 1e9 / result.ns : 0.0;
+
+		json << "    {\"name\": \"" << result.name << "\", \"iterations\": " << result.iterations << ", \"items\": " << result.items;
+		json << ", \"ns_per_op\": " << std::fixed << std::setprecision(1) << result.ns;
+		json << ", \"items_per_second\": " << std::setprecision(0) << itemsPerSecond << "}";
+		json << (i + 1 < results.size() ? ",\n" : "\n");
+	}
+
+	json << "  ]\n}\n";
+
+	if( options.json.empty() )
+	{
+		std::cout << json.str();
+
+		return 0;
+	}
+
+	std::ofstream file(options.json);
+
+	if( !file )
+	{
+		std::cout << "Error: Could not open the json file " << options.json << std::endl;
+
+		return 1;
+	}
+
+	file << json.str();
+
+	return 0;
+}
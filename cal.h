@@ -0,0 +1,194 @@
+#pragma once
+/*
+  cal.h - Calibration of the adaptive triangulation (--calibrate <file>)
+
+  NB: TriangulateOBJ.h has no dependencies to this file, only main.cpp is using it.
+
+  The engines are timed on generated polygons from 5 to 1024 corners: the concave
+  engines on stars, combs and spirals, and the sweep on zigzags (monotone) against
+  the clipping engine the polygon would get otherwise. An engine that does not give
+  n - 2 triangles with the area of the polygon counts as the slowest. A threshold is
+  the size from which (cut: up to which) an engine is the fastest at every size
+  measured, and 0 when there is no such size. The thresholds are written to the
+  file for --calibration.
+
+  Copyright (c) 2023 FalconCoding
+
+  This software is released under the terms of the
+  GNU General Public License v3.0. Details and terms of this
+  license can be found at: https://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#include <cmath>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cfloat>
+#include <iomanip>
+#include <iostream>
+#include <functional>
+
+#include "out.h"
+#include "shape.h"
+
+#include "TriangulateOBJ.h"
+
+using Engine = std::function<std::vector<obj::Triangle>(std::vector<obj::Point>&, const obj::Point&)>;
+
+inline double area_error(const std::vector<obj::Point>& polygon, const std::vector<obj::Triangle>& triangles, const obj::Point& normal) // Relative error, 1 when the count is wrong
+{
+	if( triangles.size() + 2 != polygon.size() ) return 1.0;
+
+	const auto signed_area = [&](const obj::Point& a, const obj::Point& b, const obj::Point& c)
+	{
+		const double ux = b.x - a.x, uy = b.y - a.y, uz = b.z - a.z;
+		const double vx = c.x - a.x, vy = c.y - a.y, vz = c.z - a.z;
+
+		return (uy * vz - uz * vy) * normal.x + (uz * vx - ux * vz) * normal.y + (ux * vy - uy * vx) * normal.z;
+	};
+
+	double expected(0.0), actual(0.0);
+
+	for( size_t i = 1; i + 1 < polygon.size(); i++ )
+		expected += signed_area(polygon[0], polygon[i], polygon[i + 1]);
+
+	for( const auto& t : triangles )
+		actual += signed_area(t.p0, t.p1, t.p2);
+
+	return std::fabs(actual - expected) / std::max(DBL_MIN, std::fabs(expected));
+}
+
+inline double measure(const std::vector<std::vector<obj::Point>>& polygons, const Engine& engine) // Nanoseconds for all the polygons, DBL_MAX when wrong
+{
+	std::vector<obj::Point> normals;
+
+	for( const auto& polygon : polygons )
+	{
+		normals.push_back(obj::normal(polygon));
+
+		auto copy = polygon;
+
+		if( area_error(polygon, engine(copy, normals.back()), normals.back()) > 1e-3 ) return DBL_MAX;
+	}
+
+	double best(DBL_MAX);
+
+	for( int repetition = 0; repetition < 3; repetition++ ) // Best of three, each at least 2 ms
+	{
+		size_t rounds(0);
+
+		const auto start = Clock::now();
+
+		auto elapsed = Clock::duration::zero();
+
+		do
+		{
+			for( size_t index = 0; index < polygons.size(); index++ )
+			{
+				auto copy = polygons[index];
+
+				engine(copy, normals[index]);
+			}
+
+			rounds++;
+
+			elapsed = Clock::now() - start;
+		}
+		while( elapsed < std::chrono::milliseconds(2) );
+
+		best = std::min(best, std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(rounds));
+	}
+
+	return best;
+}
+
+inline bool calibrate(const std::string& file)
+{
+	const size_t sizes[] = {5, 6, 8, 12, 16, 24, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024};
+
+	const size_t cutLimit = 256; // Cut is cubic, larger sizes only take time
+
+	const Engine cut   = [](std::vector<obj::Point>& polygon, const obj::Point& normal) { return obj::cutTriangulation(polygon, normal); };
+	const Engine clip  = [](std::vector<obj::Point>& polygon, const obj::Point& normal) { return obj::clipTriangulation(polygon, normal); };
+	const Engine grid  = [](std::vector<obj::Point>& polygon, const obj::Point& normal) { return obj::gridTriangulation(polygon, normal); };
+	const Engine sweep = [](std::vector<obj::Point>& polygon, const obj::Point& normal) { return obj::sweepTriangulation(polygon, normal); };
+
+	struct Row
+	{
+		size_t size;
+
+		double cut, clip, grid; // Concave shapes
+		double sweep, clipped;  // Zigzags, sweep and the best clipping
+	};
+
+	std::vector<Row> rows;
+
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << "corners  cut ns/corner  clip ns/corner  grid ns/corner  |  zigzag: sweep ns/corner  clip/grid ns/corner" << std::endl;
+
+	for( const auto size : sizes )
+	{
+		const std::vector<std::vector<obj::Point>> concave = {shape::star(size), shape::comb(size), shape::spiral(size)};
+		const std::vector<std::vector<obj::Point>> monotone = {shape::zigzag(size)};
+
+		Row row = {size, DBL_MAX, measure(concave, clip), measure(concave, grid), measure(monotone, sweep), 0.0};
+
+		if( size <= cutLimit ) row.cut = measure(concave, cut);
+
+		row.clipped = std::min(measure(monotone, clip), measure(monotone, grid));
+
+		rows.push_back(row);
+
+		const auto show = [&](const double ns, const size_t count, const int width)
+		{
+			std::cout << std::setw(width);
+
+			if( ns == DBL_MAX )
+				std::cout << "-";
+			else
+				std::cout << ns / static_cast<double>(count * size);
+		};
+
+		std::cout << std::setw(7) << size;
+		show(row.cut, concave.size(), 15);
+		show(row.clip, concave.size(), 16);
+		show(row.grid, concave.size(), 16);
+		std::cout << "  |";
+		show(row.sweep, monotone.size(), 25);
+		show(row.clipped, monotone.size(), 21);
+		std::cout << std::endl;
+	}
+
+	obj::Selection selection;
+
+	selection.cut = 0; // Up to the first size where cut is not the fastest
+
+	for( const auto& row : rows )
+	{
+		if( row.cut > std::min(row.clip, row.grid) ) break;
+
+		selection.cut = row.size;
+	}
+
+	selection.grid  = 0; // From the last size where grid or sweep is not the fastest
+	selection.sweep = 0;
+
+	for( auto row = rows.rbegin(); row != rows.rend() && row->grid < row->clip; ++row )
+		selection.grid = row->size;
+
+	for( auto row = rows.rbegin(); row != rows.rend() && row->sweep < row->clipped; ++row )
+		selection.sweep = row->size;
+
+	std::cout << "Thresholds: " << selection.text() << std::endl;
+
+	if( !selection.save(file) )
+	{
+		std::cout << "Error: Could not write the calibration file " << file << std::endl;
+
+		return false;
+	}
+
+	std::cout << "Calibration written to " << file << std::endl;
+
+	return true;
+}
@@ -0,0 +1,364 @@
+/*
+  client.cpp - Client and load test for the daemon mode of TriangulateOBJ (TriangulateOBJ --serve <socket>)
+
+  Copyright (c) 2023 FalconCoding
+
+  This software is released under the terms of the
+  GNU General Public License v3.0. Details and terms of this
+  license can be found at: https://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+/*
+  -[Possible command arguments]---------------------------------------------------------
+
+   TriangulateOBJ_client /tmp/triangulate.sock c:\temp\lego.obj out.obj --weld 0      (one job, as TriangulateOBJ would)
+   TriangulateOBJ_client /tmp/triangulate.sock --inline c:\temp\lego.obj out.obj      (the source bytes go with the job)
+   TriangulateOBJ_client /tmp/triangulate.sock --metrics lego.obj                     (prints the metrics JSON as well)
+   TriangulateOBJ_client /tmp/triangulate.sock --stop                                 (shuts the daemon down)
+
+   Load test, the same job 200 times from 4 clients, and as 200 processes 4 at a time:
+
+   TriangulateOBJ_client /tmp/triangulate.sock --load 200 --clients 4 --spawn ./TriangulateOBJ lego.obj out%c.obj
+
+   The client options come before the job arguments, %c in a job argument is replaced
+   by the client number so parallel clients do not write the same target. Latency is
+   measured from sending the job to the answer, and from fork to exit for processes.
+
+  --------------------------------------------------------------------------------------
+*/
+
+#ifndef _WIN32
+
+#include <mutex>
+#include <cerrno>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <iostream>
+#include <iterator>
+#include <algorithm>
+#include <filesystem>
+#include <functional>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "net.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct Options
+{
+	std::string socket;
+	std::string source; // Inline source file
+	std::string spawn;  // TriangulateOBJ to compare with, one process per job
+
+	size_t load    = 0; // Jobs of the load test, 0 runs the job once
+	size_t clients = 1;
+
+	bool metrics = false;
+	bool stop    = false;
+
+	std::vector<std::string> arguments; // Of the job
+};
+
+inline std::vector<std::string> arguments(const Options& options, const size_t client) // %c replaced by the client number
+{
+	auto result = options.arguments;
+
+	for( auto& argument : result )
+	{
+		for( auto at = argument.find("%c"); at != std::string::npos; at = argument.find("%c", at) )
+			argument.replace(at, 2, std::to_string(client));
+	}
+
+	return result;
+}
+
+inline bool job(net::Stream& stream, const net::Request& request, net::Response& response)
+{
+	if( !net::send(stream, request) || !net::receive(stream, response) )
+	{
+		std::cout << "Error: The daemon closed the connection" << std::endl;
+
+		return false;
+	}
+
+	return true;
+}
+
+inline bool spawn(const std::string& program, const std::vector<std::string>& arguments) // Waits for the process, its output is dropped
+{
+	std::vector<std::string> list = {program};
+
+	list.insert(list.end(), arguments.begin(), arguments.end());
+
+	std::vector<char*> argv;
+
+	for( auto& argument : list )
+		argv.push_back(argument.data());
+
+	argv.push_back(nullptr);
+
+	const auto pid = fork();
+
+	if( pid < 0 ) return false;
+
+	if( pid == 0 )
+	{
+		const int null = open("/dev/null", O_WRONLY);
+
+		dup2(null, STDOUT_FILENO);
+		dup2(null, STDERR_FILENO);
+
+		execv(program.c_str(), argv.data());
+
+		_exit(127);
+	}
+
+	int status(0);
+
+	while( waitpid(pid, &status, 0) < 0 )
+	{
+		if( errno != EINTR ) return false;
+	}
+
+	return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+struct Latency
+{
+	std::vector<double> seconds;
+
+	double wall = 0.0; // Seconds for all jobs
+
+	size_t failed = 0;
+
+	void print(const std::string& name, const size_t clients)
+	{
+		std::sort(seconds.begin(), seconds.end());
+
+		const auto at = [&](const double fraction) { return seconds.empty() ? 0.0 : seconds[std::min(seconds.size() - 1, static_cast<size_t>(fraction * static_cast<double>(seconds.size())))] * 1e3; };
+
+		double sum(0.0);
+
+		for( const auto value : seconds ) sum += value;
+
+		std::cout << std::fixed << std::setprecision(2);
+		std::cout << std::left << std::setw(8) << name << std::right << std::setw(6) << seconds.size() << " jobs " << std::setw(3) << clients << " clients  ";
+		std::cout << "p50 " << std::setw(8) << at(0.5) << " ms  p90 " << std::setw(8) << at(0.9) << " ms  p99 " << std::setw(8) << at(0.99) << " ms  ";
+		std::cout << "mean " << std::setw(8) << (seconds.empty() ? 0.0 : sum / static_cast<double>(seconds.size()) * 1e3) << " ms  ";
+		std::cout << std::setprecision(1) << std::setw(8) << (wall > 0.0 ? static_cast<double>(seconds.size()) / wall : 0.0) << " jobs/s";
+
+		if( failed > 0 ) std::cout << "  " << failed << " failed";
+
+		std::cout << std::endl;
+	}
+};
+
+inline Latency load(const Options& options, const std::function<bool(size_t client, const std::vector<std::string>&)>& run) // Jobs shared by the clients
+{
+	Latency latency;
+
+	std::mutex mutex;
+
+	size_t next(0);
+
+	const auto start = Clock::now();
+
+	std::vector<std::thread> threads;
+
+	for( size_t client = 0; client < options.clients; client++ )
+	{
+		threads.emplace_back([&, client]
+		{
+			const auto list = arguments(options, client);
+
+			while( true )
+			{
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+
+					if( next == options.load ) return;
+
+					next++;
+				}
+
+				const auto begin = Clock::now();
+
+				const auto ok = run(client, list);
+
+				const auto seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+				std::lock_guard<std::mutex> lock(mutex);
+
+				latency.seconds.push_back(seconds);
+
+				if( !ok ) latency.failed++;
+			}
+		});
+	}
+
+	for( auto& thread : threads )
+		thread.join();
+
+	latency.wall = std::chrono::duration<double>(Clock::now() - start).count();
+
+	return latency;
+}
+
+int main(int argc, char* argv[])
+{
+	Options options;
+
+	if( argc < 2 )
+	{
+		std::cout << "Error argument: No socket specified" << std::endl;
+
+		return 1;
+	}
+
+	options.socket = argv[1];
+
+	int i(2);
+
+	for( ; i < argc; i++ ) // Client options, the job arguments follow
+	{
+		const std::string arg = argv[i];
+
+		if( arg == "--inline" && i + 1 < argc )
+			options.source = argv[++i];
+		else if( arg == "--spawn" && i + 1 < argc )
+			options.spawn = argv[++i];
+		else if( arg == "--load" && i + 1 < argc )
+			options.load = std::strtoull(argv[++i], nullptr, 10);
+		else if( arg == "--clients" && i + 1 < argc )
+			options.clients = std::max<size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+		else if( arg == "--metrics" )
+			options.metrics = true;
+		else if( arg == "--stop" )
+			options.stop = true;
+		else
+			break;
+	}
+
+	options.arguments.assign(argv + i, argv + argc);
+
+	net::Request request;
+
+	std::error_code error;
+
+	request.stop      = options.stop;
+	request.directory = std::filesystem::current_path(error).string();
+
+	if( !options.source.empty() )
+	{
+		std::ifstream file(options.source, std::ios::binary);
+
+		request.source.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+		if( !file || request.source.empty() )
+		{
+			std::cout << "Error: Could not read the inline source " << options.source << std::endl;
+
+			return 1;
+		}
+	}
+
+	if( options.load == 0 )
+	{
+		const int fd = net::connect(options.socket);
+
+		if( fd < 0 )
+		{
+			std::cout << "Error: Could not connect to the daemon on " << options.socket << std::endl;
+
+			return 1;
+		}
+
+		net::Stream stream(fd);
+
+		net::Response response;
+
+		request.arguments = arguments(options, 0);
+
+		const auto answered = job(stream, request, response);
+
+		close(fd);
+
+		if( !answered ) return 1;
+
+		std::cout << response.log;
+
+		if( options.metrics ) std::cout << response.metrics;
+
+		return response.ok ? 0 : 1;
+	}
+
+	std::vector<int> connections(options.clients, -1); // One connection per client, kept for all its jobs
+
+	for( auto& fd : connections )
+	{
+		if( (fd = net::connect(options.socket)) < 0 )
+		{
+			std::cout << "Error: Could not connect to the daemon on " << options.socket << std::endl;
+
+			return 1;
+		}
+	}
+
+	std::vector<std::unique_ptr<net::Stream>> streams;
+
+	for( const auto fd : connections )
+		streams.push_back(std::make_unique<net::Stream>(fd));
+
+	auto daemon = load(options, [&](const size_t client, const std::vector<std::string>& list)
+	{
+		auto copy = request;
+
+		copy.arguments = list;
+
+		net::Response response;
+
+		return job(*streams[client], copy, response) && response.ok;
+	});
+
+	for( const auto fd : connections )
+		close(fd);
+
+	daemon.print("daemon", options.clients);
+
+	if( options.spawn.empty() ) return daemon.failed == 0 ? 0 : 1;
+
+	auto process = load(options, [&](const size_t, std::vector<std::string> list)
+	{
+		if( !options.source.empty() ) list.insert(list.begin(), options.source);
+
+		return spawn(options.spawn, list);
+	});
+
+	process.print("process", options.clients);
+
+	return daemon.failed == 0 && process.failed == 0 ? 0 : 1;
+}
+
+#else
+
+#include <iostream>
+
+int main()
+{
+	std::cout << "Error: The daemon mode needs Unix domain sockets, not available on this platform" << std::endl;
+
+	return 1;
+}
+
+#endif
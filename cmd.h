@@ -24,12 +24,47 @@
   
    (*) Best choice => triangulated file => c:\temp\lego.triangulated.obj
 
+       c:\temp\lego.obj c:\temp\lego.stl                                (binary STL)
+       c:\temp\lego.obj c:\temp\lego.ply                                (binary PLY)
+
+   Options can be placed anywhere on the command line:
+
+       --metrics-json <file>    Write counts, sizes, timings, throughput and memory as JSON
+       --progress <seconds>     Print progress, throughput and ETA at this interval
+       --trace <file>           Write a timeline of the conversion as Chrome trace JSON (Perfetto)
+       --incremental            Skip the conversion when the target was made from this very source
+       --lazy-vertices          Decode vertices only when a polygon uses them (files with mostly triangles)
+       --memory <n>[K|M|G]      Keep at most this much vertex memory, the rest in a temporary file (meshes larger than RAM)
+       --weld <tolerance>       Merge vertices within the tolerance (0 = equal positions only), renumber the faces
+       --sort <material|group>  Write the faces grouped by material (and by group within a material)
+       --chunk <v>[:<t>]        Split the triangles into chunks of at most v vertices and t triangles (65535, 64:124)
+       --adaptive               Pick the triangulation engine per polygon from its size and shape
+       --calibration <file>     Adaptive, with the thresholds measured by --calibrate
+       --split <corners>        Split polygons from this size on diagonals and triangulate the pieces on every thread
+       --mapped-output          Write the batches on every thread into the memory-mapped target (OBJ and STL, not Windows)
+       --io <stdio|uring>       Read and write through buffered stdio (default) or io_uring with requests in flight (Linux)
+
+   Calibration, no files on the command line (see cal.h):
+
+       --calibrate <file>       Time the engines on this machine and write the thresholds for --calibration
+
+   Daemon mode, no files on the command line (see srv.h and client.cpp):
+
+       --serve <socket>         Run conversion jobs sent to this Unix domain socket, on one warm worker pool
+
+   Watch mode, new and changed obj files in a folder are converted (see dir.h):
+
+       --watch <folder> [<target directory>]
+       --debounce <seconds>     Quiet time before a changed file is converted (0.5)
+       --jobs <n>               Files converted at the same time (all cores shared between them)
+
   --------------------------------------------------------------------------------------
 */
 
 #include "div.h"
 
 #include <string>
+#include <cstdlib>
 #include <iostream>
 #include <filesystem>
 
@@ -41,8 +76,49 @@ using Path = std::filesystem::path;
 static Path source;
 static Path target;
 
+static Path metrics_json;
+
+static double progress_interval = 0.0;
+
+static Path trace_json;
+
+static bool incremental = false;
+
+static bool lazy_vertices = false;
+
+static size_t memory_budget = 0; // Zero keeps every vertex in memory
+
+static double weld_tolerance = -1.0; // Negative when not welding
+
+static std::string sort_faces; // Empty, material or group
+
+static size_t chunk_vertices  = 0; // Zero when not chunking
+static size_t chunk_triangles = 0;
+
+static bool adaptive = false;
+
+static size_t split_corners = 0; // Zero when not splitting
+
+static bool mapped_output = false;
+
+static std::string io_backend; // Empty, stdio or uring
+
+static Path calibration_file; // Empty for the built in thresholds
+static Path calibrate_file;   // Empty when converting the files on the command line
+
+static Path serve_socket; // Empty when converting the files on the command line
+
+static Path watch_folder; // Empty when converting the files on the command line
+static Path watch_target; // Empty when the targets go next to the sources
+
+static double watch_debounce = 0.5;
+
+static size_t watch_jobs = 0; // Zero picks from the core count
+
 bool arg();
 
+bool option(int& argc, char* argv[]);
+
 bool arg1(char* argv[]);
 
 bool arg2(char* argv[]);
@@ -51,10 +127,90 @@ bool arg3(char* argv[]);
 
 void launch();
 
-inline bool arg(const int argc, char* argv[])
+inline void defaults() // Options of the previous job are cleared before the next one in daemon mode
+{
+	source.clear();
+	target.clear();
+
+	metrics_json.clear();
+	trace_json.clear();
+
+	progress_interval = 0.0;
+
+	incremental   = false;
+	lazy_vertices = false;
+
+	memory_budget = 0;
+
+	weld_tolerance = -1.0;
+
+	sort_faces.clear();
+
+	chunk_vertices  = 0;
+	chunk_triangles = 0;
+
+	adaptive = false;
+
+	split_corners = 0;
+
+	mapped_output = false;
+
+	io_backend.clear();
+
+	calibration_file.clear();
+	calibrate_file.clear();
+
+	serve_socket.clear();
+
+	watch_folder.clear();
+	watch_target.clear();
+}
+
+inline Path labelled(const Path& source) // The default target, next to the source
+{
+	Path path = source;
+
+	path.replace_filename(source.stem().string() + "." + file_lbl + "." + file_ext);
+
+	return path;
+}
+
+inline bool is_labelled(const Path& path) // A target with the default name, never taken as a source
+{
+	const auto name = path.filename().string();
+	const auto tail = "." + file_lbl + "." + file_ext;
+
+	return name.size() > tail.size() && name.compare(name.size() - tail.size(), tail.size(), tail) == 0;
+}
+
+bool watch_arg(int argc, char* argv[]);
+
+inline bool arg(int argc, char* argv[])
 {
 	launch();
 
+	if( !option(argc, argv) ) return false;
+
+	if( !watch_folder.empty() ) return watch_arg(argc, argv);
+
+	if( !serve_socket.empty() )
+	{
+		if( argc == 1 ) return true;
+
+		std::cout << "Error argument: --serve takes no files, the jobs name them" << std::endl;
+
+		return false;
+	}
+
+	if( !calibrate_file.empty() )
+	{
+		if( argc == 1 ) return true;
+
+		std::cout << "Error argument: --calibrate takes no files" << std::endl;
+
+		return false;
+	}
+
 	switch( argc )
 	{
 	case 1:return arg1(argv);
@@ -64,6 +220,164 @@ inline bool arg(const int argc, char* argv[])
 	}
 }
 
+inline bool option(int& argc, char* argv[]) // Takes the options out of argv, leaving the file arguments
+{
+	int n(1);
+
+	for( int i = 1; i < argc; i++ )
+	{
+		const std::string arg = argv[i];
+
+		if( arg.rfind("--", 0) != 0 )
+		{
+			argv[n++] = argv[i];
+
+			continue;
+		}
+
+		if( arg == "--incremental" )
+		{
+			incremental = true;
+
+			continue;
+		}
+
+		if( arg == "--lazy-vertices" )
+		{
+			lazy_vertices = true;
+
+			continue;
+		}
+
+		if( arg == "--mapped-output" )
+		{
+			mapped_output = true;
+
+			continue;
+		}
+
+		if( arg == "--adaptive" )
+		{
+			adaptive = true;
+
+			continue;
+		}
+
+		if( i + 1 >= argc )
+		{
+			std::cout << "Error argument: Missing value for " << arg << std::endl;
+
+			return false;
+		}
+
+		if( arg == "--metrics-json" )
+			metrics_json = argv[++i];
+		else if( arg == "--progress" )
+			progress_interval = std::atof(argv[++i]);
+		else if( arg == "--trace" )
+			trace_json = argv[++i];
+		else if( arg == "--calibration" )
+		{
+			calibration_file = argv[++i];
+
+			adaptive = true;
+		}
+		else if( arg == "--calibrate" )
+			calibrate_file = argv[++i];
+		else if( arg == "--serve" )
+			serve_socket = argv[++i];
+		else if( arg == "--watch" )
+			watch_folder = argv[++i];
+		else if( arg == "--debounce" )
+			watch_debounce = std::max(0.0, std::atof(argv[++i]));
+		else if( arg == "--jobs" )
+			watch_jobs = std::strtoull(argv[++i], nullptr, 10);
+		else if( arg == "--memory" )
+		{
+			char* end = nullptr;
+
+			memory_budget = std::strtoull(argv[++i], &end, 10);
+
+			switch( *end )
+			{
+			case 'k':case 'K':memory_budget <<= 10; end++; break;
+			case 'm':case 'M':memory_budget <<= 20; end++; break;
+			case 'g':case 'G':memory_budget <<= 30; end++; break;
+			default:break;
+			}
+
+			if( memory_budget == 0 || *end != '\0' )
+			{
+				std::cout << "Error argument: Invalid memory budget " << argv[i] << " (bytes, or with K, M or G)" << std::endl;
+
+				return false;
+			}
+		}
+		else if( arg == "--weld" )
+			weld_tolerance = std::max(0.0, std::atof(argv[++i]));
+		else if( arg == "--chunk" )
+		{
+			char* end = nullptr;
+
+			chunk_vertices = std::strtoull(argv[++i], &end, 10);
+
+			if( *end == ':' ) chunk_triangles = std::strtoull(end + 1, &end, 10);
+
+			if( chunk_vertices < 3 || *end != '\0' )
+			{
+				std::cout << "Error argument: Invalid chunk size " << argv[i] << " (vertices[:triangles], at least 3 vertices)" << std::endl;
+
+				return false;
+			}
+		}
+		else if( arg == "--split" )
+		{
+			char* end = nullptr;
+
+			split_corners = std::strtoull(argv[++i], &end, 10);
+
+			if( split_corners < 4 || *end != '\0' )
+			{
+				std::cout << "Error argument: Invalid split size " << argv[i] << " (corners, at least 4)" << std::endl;
+
+				return false;
+			}
+		}
+		else if( arg == "--sort" )
+		{
+			sort_faces = argv[++i];
+
+			if( sort_faces != "material" && sort_faces != "group" )
+			{
+				std::cout << "Error argument: Unknown sort order " << sort_faces << " (material or group)" << std::endl;
+
+				return false;
+			}
+		}
+		else if( arg == "--io" )
+		{
+			io_backend = argv[++i];
+
+			if( io_backend != "stdio" && io_backend != "uring" )
+			{
+				std::cout << "Error argument: Unknown I/O backend " << io_backend << " (stdio or uring)" << std::endl;
+
+				return false;
+			}
+		}
+		else
+		{
+			std::cout << "Error argument: Unknown option " << arg << std::endl;
+
+			return false;
+		}
+	}
+
+	argc = n;
+
+	return true;
+}
+
 inline bool arg1(char* argv[])
 {
 	std::cout << "Error: No source " << file_ext << " file specified" << std::endl;
@@ -89,8 +403,7 @@ inline bool arg2(char* argv[])
 		return false;
 	}
 
-	target = source;
-	target.replace_filename(source.stem().string() + "." + file_lbl + "." + file_ext);
+	target = labelled(source);
 
 	return true;
 }
@@ -120,9 +433,9 @@ inline bool arg3(char* argv[])
 		return false;
 	}
 
-	if( ext(target) != file_ext )
+	if( ext(target) != file_ext && ext(target) != "stl" && ext(target) != "ply" )
 	{
-		std::cout << "Error: Target file is not an " << file_ext << " file " << target.string() << std::endl;
+		std::cout << "Error: Target file is not an " << file_ext << ", stl or ply file " << target.string() << std::endl;
 
 		return false;
 	}
@@ -137,6 +450,34 @@ inline bool arg3(char* argv[])
 	return true;
 }
 
+inline bool watch_arg(int argc, char* argv[])
+{
+	if( !is_directory(watch_folder) )
+	{
+		std::cout << "Error: Watch folder is unknown " << watch_folder.string() << std::endl;
+
+		return false;
+	}
+
+	if( argc > 2 ) return arg();
+
+	if( argc == 1 ) return true;
+
+	watch_target = argv[1];
+
+	if( !is_directory(watch_target) )
+	{
+		std::cout << "Error: Target directory is unknown " << watch_target.string() << std::endl;
+
+		return false;
+	}
+
+	if( equivalent(watch_target, watch_folder) )
+		watch_target.clear();
+
+	return true;
+}
+
 inline bool arg()
 {
 	std::cout << "Error argument: Too many arguments" << std::endl;
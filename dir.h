@@ -0,0 +1,336 @@
+#pragma once
+/*
+  dir.h - Watch mode, obj files written to a folder are converted as they arrive
+
+  NB: TriangulateOBJ.h has no dependencies to this file, only main.cpp is using it.
+
+  On Linux inotify reports the files written, closed or moved into the folder, on
+  other platforms the folder is scanned once a second. A file is converted once it
+  had no events for the debounce time and has the same size and modification time
+  as at its last event, so a file still being written, or rewritten in quick
+  succession, is converted once. Targets with the file_lbl name are never taken as
+  sources. Every conversion is incremental, the files found at start that are
+  already converted are skipped. Several files are converted at the same time, each
+  conversion with an equal share of the cores.
+
+  Copyright (c) 2023 FalconCoding
+
+  This software is released under the terms of the
+  GNU General Public License v3.0. Details and terms of this
+  license can be found at: https://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#include <map>
+#include <set>
+#include <deque>
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+#include <filesystem>
+#include <condition_variable>
+
+#include "cmd.h"
+#include "div.h"
+#include "out.h"
+
+#include "TriangulateOBJ.h"
+
+#ifdef __linux__
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
+using Configure = std::function<void(obj::Triangulate&)>; // Sets the options of the command line
+
+class Ingest // Files converted on their own threads, a file is never converted twice at the same time
+{
+public:
+
+	Ingest(const size_t jobs, const Path& into, const Configure& configure) : into(into), configure(configure)
+	{
+		const auto cores = std::max(1u, std::thread::hardware_concurrency());
+
+		const auto count = jobs > 0 ? jobs : std::min<size_t>(4, cores);
+
+		for( size_t id = 0; id < count; id++ )
+			thread.emplace_back(&Ingest::loop, this, std::max<size_t>(1, cores / count));
+	}
+
+	~Ingest() // Finishes the running conversions, the queued ones are dropped
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			stop = true;
+
+			queue.clear();
+		}
+
+		wake.notify_all();
+
+		for( auto& item : thread )
+			item.join();
+	}
+
+	Ingest(const Ingest&) = delete;
+
+	Ingest& operator=(const Ingest&) = delete;
+
+	bool add(const Path& path) // False when the file is queued or converting
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			if( !active.insert(path).second ) return false;
+
+			queue.push_back(path);
+		}
+
+		wake.notify_one();
+
+		return true;
+	}
+
+private:
+
+	void loop(const size_t threads)
+	{
+		obj::Triangulate obj;
+
+		configure(obj);
+
+		obj.incremental(true);
+
+		obj.threads(threads);
+
+		while( true )
+		{
+			Path path;
+
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+
+				wake.wait(lock, [this] { return stop || !queue.empty(); });
+
+				if( stop ) return;
+
+				path = queue.front();
+
+				queue.pop_front();
+			}
+
+			const auto target = into.empty() ? labelled(path) : into / path.filename();
+
+			const auto start = Clock::now();
+
+			const auto triangulated = obj.triangulate(path.string(), target.string());
+
+			const auto time = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+
+			std::lock_guard<std::mutex> lock(mutex);
+
+			if( obj.skipped() )
+				std::cout << path.string() << " is unchanged, " << target.string() << " is up to date" << std::endl;
+			else if( triangulated )
+				std::cout << path.string() << " has been triangulated in " << stopwatch(time) << std::endl;
+			else
+				std::cout << path.string() << " can not be triangulated" << std::endl;
+
+			active.erase(path);
+		}
+	}
+
+	const Path into;
+
+	const Configure configure;
+
+	std::mutex mutex;
+	std::condition_variable wake;
+
+	std::deque<Path> queue;
+	std::set<Path> active; // Queued or converting
+
+	std::vector<std::thread> thread;
+
+	bool stop = false;
+};
+
+inline bool watch(const Path& folder, const Path& into, const size_t jobs, const double debounce, const Configure& configure)
+{
+	struct Change
+	{
+		Clock::time_point due; // Converted when there is no event before this
+
+		std::uintmax_t size = 0;
+
+		std::filesystem::file_time_type time;
+	};
+
+	const auto quiet = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(debounce));
+
+	std::map<Path, Change> changed;
+
+	std::map<Path, std::pair<std::uintmax_t, std::filesystem::file_time_type>> seen; // Scanning, the files as of the last scan
+
+	const auto touch = [&](const Path& path) // An event, or a new or changed file found by a scan
+	{
+		if( ext(path) != file_ext || is_labelled(path) ) return;
+
+		std::error_code error;
+
+		auto& change = changed[path];
+
+		change.due  = Clock::now() + quiet;
+		change.size = std::filesystem::file_size(path, error);
+		change.time = std::filesystem::last_write_time(path, error);
+	};
+
+	const auto scan = [&]
+	{
+		std::error_code error;
+
+		for( const auto& entry : std::filesystem::directory_iterator(folder, error) )
+		{
+			std::error_code failed;
+
+			if( !entry.is_regular_file(failed) ) continue;
+
+			const auto now = std::make_pair(entry.file_size(failed), entry.last_write_time(failed));
+
+			if( failed ) continue;
+
+			auto found = seen.find(entry.path());
+
+			if( found != seen.end() && found->second == now ) continue;
+
+			seen[entry.path()] = now;
+
+			touch(entry.path());
+		}
+	};
+
+#ifdef __linux__
+	const int events = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+	if( events < 0 || inotify_add_watch(events, folder.string().c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_MODIFY) < 0 )
+	{
+		std::cout << "Error: Could not watch the folder " << folder.string() << std::endl;
+
+		if( events >= 0 ) close(events);
+
+		return false;
+	}
+#endif
+
+	catch_interrupt();
+
+	std::cout << "Watching " << folder.string() << " for " << file_ext << " files, Ctrl+C to stop" << std::endl;
+
+	Ingest ingest(jobs, into, configure);
+
+	scan(); // The files already there
+
+#ifndef __linux__
+	auto scanned = Clock::now();
+#endif
+
+	while( !interrupted )
+	{
+		auto wait = std::chrono::milliseconds(200); // Checks for Ctrl+C 5 times a second
+
+		for( const auto& item : changed )
+			wait = std::min(wait, std::chrono::duration_cast<std::chrono::milliseconds>(std::max(Clock::duration::zero(), item.second.due - Clock::now())));
+
+#ifdef __linux__
+		pollfd ready = {events, POLLIN, 0};
+
+		if( poll(&ready, 1, static_cast<int>(wait.count()) + 1) > 0 )
+		{
+			alignas(inotify_event) char buffer[64 << 10];
+
+			ssize_t bytes;
+
+			while( (bytes = read(events, buffer, sizeof buffer)) > 0 )
+			{
+				for( ssize_t at = 0; at < bytes; )
+				{
+					const auto* event = reinterpret_cast<const inotify_event*>(buffer + at);
+
+					if( event->mask & IN_Q_OVERFLOW ) // Events were lost, look at every file again
+					{
+						seen.clear();
+
+						scan();
+					}
+					else if( event->len > 0 && !(event->mask & IN_ISDIR) )
+						touch(folder / event->name);
+
+					at += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+				}
+			}
+		}
+#else
+		std::this_thread::sleep_for(wait + std::chrono::milliseconds(1));
+
+		if( Clock::now() - scanned >= std::chrono::seconds(1) )
+		{
+			scan();
+
+			scanned = Clock::now();
+		}
+#endif
+
+		const auto now = Clock::now();
+
+		for( auto item = changed.begin(); item != changed.end(); )
+		{
+			auto& change = item->second;
+
+			if( change.due > now )
+			{
+				++item;
+
+				continue;
+			}
+
+			std::error_code error;
+
+			const auto size = std::filesystem::file_size(item->first, error);
+			const auto time = std::filesystem::last_write_time(item->first, error);
+
+			if( error ) // Removed or renamed before it was converted
+			{
+				item = changed.erase(item);
+
+				continue;
+			}
+
+			if( size != change.size || time != change.time || !ingest.add(item->first) ) // Still written, or converting an older version
+			{
+				change.due  = now + quiet;
+				change.size = size;
+				change.time = time;
+
+				++item;
+
+				continue;
+			}
+
+			item = changed.erase(item);
+		}
+	}
+
+#ifdef __linux__
+	close(events);
+#endif
+
+	std::cout << "Stopped watching " << folder.string() << ", finishing the running conversions" << std::endl;
+
+	return true;
+}
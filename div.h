@@ -1,13 +1,14 @@
 #pragma once
 
 /*
-  div.h - Helper class for cmd.h + out.h
+  div.h - Helper class for cmd.h + out.h + srv.h + dir.h
 
   NB: TriangulateOBJ.h has no dependencies to this file.
 */
 
 #include <string>
 #include <locale>
+#include <csignal>
 
 #include <algorithm>
 #include <filesystem>
@@ -50,3 +51,11 @@ inline std::string ext(const std::filesystem::path& path)
 
 	return ext.substr(1);
 }
+
+static volatile std::sig_atomic_t interrupted = 0;
+
+inline void catch_interrupt() // Ctrl+C and SIGTERM set interrupted, the daemon and watch loops stop on it
+{
+	std::signal(SIGINT, [](int) { interrupted = 1; });
+	std::signal(SIGTERM, [](int) { interrupted = 1; });
+}
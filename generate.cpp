@@ -0,0 +1,482 @@
+/*
+  generate.cpp - Deterministic generator of large synthetic OBJ files
+
+  Copyright (c) 2023 FalconCoding
+
+  This software is released under the terms of the
+  GNU General Public License v3.0. Details and terms of this
+  license can be found at: https://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+/*
+  -[Possible command arguments]---------------------------------------------------------
+
+   TriangulateOBJ_generate big.obj --faces 100000000
+   TriangulateOBJ_generate big.obj --size 4G --quads 0.9 --ngons 0.01 --ngon-size 64:50000
+   TriangulateOBJ_generate big.obj --faces 1000000 --tokens v/vt/vn --negative 0.5 --groups 100 --materials 8
+   TriangulateOBJ_generate huge.obj --faces 1000000 --pad 5G           (past 4 GB, sparse, little disk)
+
+   --faces <n>          Stop after n faces
+   --size <n>[K|M|G]    Stop after n bytes (whichever of --faces and --size comes first)
+   --quads <share>      Share of quads (0..1)                                 default 0.8
+   --ngons <share>      Share of large concave n-gons, the rest are triangles  default 0.05
+   --ngon-size <a:b>    Corner count range of the n-gons                       default 16:256
+   --negative <share>   Share of faces written with negative (relative) indices default 0
+   --tokens <form>      v, v/vt, v//vn or v/vt/vn                               default v
+   --groups <n>         Number of g sections                                    default 0
+   --materials <n>      Number of materials, usemtl switches at every group     default 0
+                        (written to an .mtl file named after the target)
+   --seed <n>           Seed, the same seed and options give the same file      default 1
+   --pad <n>[K|M|G]     Sparse comment lines of 1 MB before the geometry        default 0
+
+  --------------------------------------------------------------------------------------
+*/
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <filesystem>
+
+#include "shape.h"
+
+struct Options
+{
+	std::string file;
+
+	uint64_t faces = 0;
+	uint64_t bytes = 0;
+
+	double quads    = 0.80;
+	double ngons    = 0.05;
+	double negative = 0.00;
+
+	size_t ngonMin = 16;
+	size_t ngonMax = 256;
+
+	bool vt = false;
+	bool vn = false;
+
+	uint64_t groups    = 0;
+	uint64_t materials = 0;
+
+	uint64_t seed = 1;
+
+	uint64_t pad = 0;
+};
+
+class Writer
+{
+public:
+
+	explicit Writer(FILE* file) : file(file), written(0) { buffer.reserve(BUFFER_BYTES + 4096); }
+
+	void put(const char c) { buffer += c; }
+
+	void put(const char* text) { buffer += text; }
+
+	void put(const std::string& text) { buffer += text; }
+
+	void put(uint64_t value)
+	{
+		char digits[24];
+
+		int n(0);
+
+		do
+		{
+			digits[n++] = static_cast<char>('0' + value % 10);
+
+			value /= 10;
+		}
+		while( value != 0 );
+
+		while( n > 0 ) buffer += digits[--n];
+	}
+
+	void put(const float value) // Fixed point with 4 decimals
+	{
+		auto scaled = static_cast<int64_t>(static_cast<double>(value) * 10000.0 + (value < 0.0f ? -0.5 : 0.5));
+
+		if( scaled < 0 )
+		{
+			buffer += '-';
+
+			scaled = -scaled;
+		}
+
+		put(static_cast<uint64_t>(scaled / 10000));
+
+		buffer += '.';
+
+		const auto fraction = static_cast<int>(scaled % 10000);
+
+		buffer += static_cast<char>('0' + fraction / 1000);
+		buffer += static_cast<char>('0' + fraction / 100 % 10);
+		buffer += static_cast<char>('0' + fraction / 10 % 10);
+		buffer += static_cast<char>('0' + fraction % 10);
+	}
+
+	void line() // Ends a line and writes the buffer once it is full
+	{
+		buffer += '\n';
+
+		if( buffer.size() >= BUFFER_BYTES ) flush();
+	}
+
+	bool flush()
+	{
+		if( buffer.empty() ) return true;
+
+		const auto ok = fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+
+		written += buffer.size();
+
+		buffer.clear();
+
+		return ok;
+	}
+
+	uint64_t size() const { return written + buffer.size(); }
+
+	bool pad(const uint64_t bytes) // Comment lines of '#', a hole and '\n', so the file system stores one block per line
+	{
+		constexpr uint64_t LINE_BYTES = 1 << 20;
+
+		if( !flush() ) return false;
+
+		const auto start = written;
+
+		for( uint64_t at = start; at + LINE_BYTES <= start + bytes; at += LINE_BYTES )
+		{
+			if( obj::seek(file, at) != 0 || fputc('#', file) == EOF ) return false;
+			if( obj::seek(file, at + LINE_BYTES - 1) != 0 || fputc('\n', file) == EOF ) return false;
+		}
+
+		written += bytes / LINE_BYTES * LINE_BYTES;
+
+		return obj::seek(file, written) == 0;
+	}
+
+private:
+
+	static constexpr size_t BUFFER_BYTES = 4 << 20;
+
+	FILE* file;
+
+	std::string buffer;
+
+	uint64_t written;
+};
+
+inline uint64_t bytes(const std::string& text)
+{
+	char* end = nullptr;
+
+	auto value = std::strtoull(text.c_str(), &end, 10);
+
+	switch( *end )
+	{
+	case 'k':case 'K':value <<= 10; break;
+	case 'm':case 'M':value <<= 20; break;
+	case 'g':case 'G':value <<= 30; break;
+	case 't':case 'T':value <<= 40; break;
+	default:break;
+	}
+
+	return value;
+}
+
+inline bool arg(const int argc, char* argv[], Options& options)
+{
+	if( argc < 2 )
+	{
+		std::cout << "Error: No target obj file specified" << std::endl;
+
+		return false;
+	}
+
+	options.file = argv[1];
+
+	for( int i = 2; i < argc; i++ )
+	{
+		const std::string arg = argv[i];
+
+		if( i + 1 >= argc )
+		{
+			std::cout << "Error argument: Missing value for " << arg << std::endl;
+
+			return false;
+		}
+
+		const std::string value = argv[++i];
+
+		if( arg == "--faces" )
+			options.faces = std::strtoull(value.c_str(), nullptr, 10);
+		else if( arg == "--size" )
+			options.bytes = bytes(value);
+		else if( arg == "--quads" )
+			options.quads = std::atof(value.c_str());
+		else if( arg == "--ngons" )
+			options.ngons = std::atof(value.c_str());
+		else if( arg == "--negative" )
+			options.negative = std::atof(value.c_str());
+		else if( arg == "--groups" )
+			options.groups = std::strtoull(value.c_str(), nullptr, 10);
+		else if( arg == "--materials" )
+			options.materials = std::strtoull(value.c_str(), nullptr, 10);
+		else if( arg == "--seed" )
+			options.seed = std::strtoull(value.c_str(), nullptr, 10);
+		else if( arg == "--pad" )
+			options.pad = bytes(value);
+		else if( arg == "--ngon-size" )
+		{
+			const auto colon = value.find(':');
+
+			options.ngonMin = std::strtoull(value.substr(0, colon).c_str(), nullptr, 10);
+			options.ngonMax = colon == std::string::npos ? options.ngonMin : std::strtoull(value.substr(colon + 1).c_str(), nullptr, 10);
+		}
+		else if( arg == "--tokens" )
+		{
+			options.vt = value == "v/vt" || value == "v/vt/vn";
+			options.vn = value == "v//vn" || value == "v/vt/vn";
+
+			if( !options.vt && !options.vn && value != "v" )
+			{
+				std::cout << "Error argument: Unknown token form " << value << std::endl;
+
+				return false;
+			}
+		}
+		else
+		{
+			std::cout << "Error argument: Unknown argument " << arg << std::endl;
+
+			return false;
+		}
+	}
+
+	if( options.faces == 0 && options.bytes == 0 )
+	{
+		std::cout << "Error argument: Specify --faces or --size" << std::endl;
+
+		return false;
+	}
+
+	if( options.ngonMin < 4 || options.ngonMax < options.ngonMin )
+	{
+		std::cout << "Error argument: Invalid --ngon-size" << std::endl;
+
+		return false;
+	}
+
+	return true;
+}
+
+inline bool library(const std::string& path, const uint64_t materials) // The .mtl file the usemtl statements refer to, a grey of its own for every material
+{
+	FILE* file = fopen(path.c_str(), "wb");
+
+	if( file == nullptr ) return false;
+
+	fprintf(file, "# Materials generated by TriangulateOBJ_generate\n");
+
+	for( uint64_t index = 0; index < materials; index++ )
+	{
+		const auto grey = 0.2 + 0.6 * static_cast<double>(index) / static_cast<double>(materials);
+
+		fprintf(file, "\nnewmtl material%llu\nKd %.3f %.3f %.3f\n", static_cast<unsigned long long>(index), grey, grey, grey);
+	}
+
+	return fclose(file) == 0;
+}
+
+int main(int argc, char* argv[])
+{
+	Options options;
+
+	if( !arg(argc, argv, options) ) return 1;
+
+	FILE* file = fopen(options.file.c_str(), "wb");
+
+	if( file == nullptr )
+	{
+		std::cout << "Error: Could not open the target file " << options.file << std::endl;
+
+		return 1;
+	}
+
+	shape::Random random(options.seed);
+
+	Writer out(file);
+
+	out.put("# Synthetic OBJ file generated by TriangulateOBJ_generate");
+	out.line();
+
+	if( options.pad > 0 && !out.pad(options.pad) )
+	{
+		std::cout << "Error: Could not pad the target file " << options.file << std::endl;
+
+		fclose(file);
+
+		return 1;
+	}
+
+	if( options.materials > 0 )
+	{
+		const auto mtl = std::filesystem::path(options.file).replace_extension(".mtl");
+
+		if( !library(mtl.string(), options.materials) )
+		{
+			std::cout << "Error: Could not write the material file " << mtl.string() << std::endl;
+
+			fclose(file);
+
+			return 1;
+		}
+
+		out.put("mtllib ");
+		out.put(mtl.filename().string());
+		out.line();
+	}
+
+	const auto limit = [&](const uint64_t face)
+	{
+		if( options.faces != 0 && face >= options.faces ) return true;
+		if( options.bytes != 0 && out.size() >= options.bytes ) return true;
+
+		return false;
+	};
+
+	// Faces are laid out on a grid; with --size the face count is unknown up front, so groups switch every 1M faces then
+
+	const uint64_t groupLength = options.groups == 0 ? 0 : options.faces != 0 ? std::max<uint64_t>(1, options.faces / options.groups) : 1'000'000;
+
+	uint64_t vertices(0), normals(0), groups(0);
+
+	std::vector<obj::Point> polygon;
+
+	for( uint64_t face = 0; !limit(face); face++ )
+	{
+		if( groupLength != 0 && face % groupLength == 0 && groups < options.groups )
+		{
+			out.put("g group");
+			out.put(groups);
+			out.line();
+
+			if( options.materials > 0 )
+			{
+				out.put("usemtl material");
+				out.put(groups % options.materials);
+				out.line();
+			}
+
+			groups++;
+		}
+
+		const auto kind = random.real();
+
+		auto star = false;
+
+		if( kind < options.quads )
+			polygon = shape::convex(4);
+		else if( kind < options.quads + options.ngons )
+		{
+			const auto n = random.range(options.ngonMin, options.ngonMax);
+
+			star = random.next() % 2 == 0;
+
+			polygon = star ? shape::star(n) : shape::comb(n);
+		}
+		else
+			polygon = shape::convex(3);
+
+		const auto x = static_cast<float>(face % 1000) * 4.0f;
+		const auto y = static_cast<float>(face / 1000 % 1000) * 4.0f;
+		const auto z = static_cast<float>(face / 1'000'000);
+
+		// Stars grow with their corner count so neighbouring corners stay apart at 4 decimals, combs have unit teeth anyway
+
+		const auto scale = star ? std::max(1.0f, static_cast<float>(polygon.size()) / 16.0f) : 1.0f;
+
+		for( const auto& point : polygon )
+		{
+			out.put("v ");
+			out.put(x + static_cast<float>(point.x) * scale);
+			out.put(' ');
+			out.put(y + static_cast<float>(point.y) * scale);
+			out.put(' ');
+			out.put(z);
+			out.line();
+
+			if( !options.vt ) continue;
+
+			out.put("vt ");
+			out.put(static_cast<float>(point.x) * 0.5f + 0.5f);
+			out.put(' ');
+			out.put(static_cast<float>(point.y) * 0.5f + 0.5f);
+			out.line();
+		}
+
+		if( options.vn )
+		{
+			out.put("vn 0 0 1");
+			out.line();
+
+			normals++;
+		}
+
+		const auto relative = random.real() < options.negative;
+
+		const auto n = polygon.size();
+
+		out.put('f');
+
+		for( size_t i = 0; i < n; i++ )
+		{
+			out.put(' ');
+
+			if( relative ) out.put('-');
+
+			out.put(relative ? n - i : vertices + i + 1);
+
+			if( !options.vt && !options.vn ) continue;
+
+			out.put('/');
+
+			if( options.vt )
+			{
+				if( relative ) out.put('-');
+
+				out.put(relative ? n - i : vertices + i + 1);
+			}
+
+			if( !options.vn ) continue;
+
+			out.put('/');
+
+			if( relative ) out.put('-');
+
+			out.put(relative ? uint64_t(1) : normals);
+		}
+
+		out.line();
+
+		vertices += n;
+	}
+
+	const auto ok = out.flush() && fclose(file) == 0;
+
+	if( !ok )
+	{
+		std::cout << "Error: Could not write the target file " << options.file << std::endl;
+
+		return 1;
+	}
+
+	std::cout << options.file << " has been generated" << std::endl;
+
+	return 0;
+}
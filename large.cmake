@@ -0,0 +1,78 @@
+# large.cmake - Conversion of a sparse source past 4 GB (ctest -L large)
+#
+# cmake -DGENERATE=<TriangulateOBJ_generate> -DCONVERT=<TriangulateOBJ> -DFOLDER=<work folder> -P large.cmake
+#
+# The same faces are generated with and without --pad 5G, so every vertex and face of the padded file lies past
+# 4 GB. Both are converted to STL, which leaves the 5 GB of padding out of the target, and the padded conversions
+# (also with --lazy-vertices, which seeks back into the source) must give the same triangle count and triangles.
+
+cmake_minimum_required (VERSION 3.13) # math() reads hexadecimal
+
+set (OPTIONS --faces 20000 --quads 0.8 --ngons 0.05 --ngon-size 16:64 --tokens v/vt/vn --negative 0.5 --groups 4)
+
+file (REMOVE_RECURSE "${FOLDER}")
+file (MAKE_DIRECTORY "${FOLDER}/plain" "${FOLDER}/padded" "${FOLDER}/lazy")
+
+function (run)
+  execute_process (COMMAND ${ARGN} RESULT_VARIABLE result OUTPUT_QUIET)
+
+  if (NOT result EQUAL 0)
+    message (FATAL_ERROR "Failed: ${ARGN}")
+  endif()
+endfunction()
+
+run (${GENERATE} "${FOLDER}/plain/large.obj" ${OPTIONS})
+run (${GENERATE} "${FOLDER}/padded/large.obj" ${OPTIONS} --pad 5G)
+
+file (SIZE "${FOLDER}/padded/large.obj" size)
+
+if (size LESS 5368709120)
+  message (FATAL_ERROR "The padded source is ${size} bytes, not past 4 GB")
+endif()
+
+run (${CONVERT} "${FOLDER}/plain/large.obj" "${FOLDER}/plain/large.stl")
+run (${CONVERT} "${FOLDER}/padded/large.obj" "${FOLDER}/padded/large.stl")
+run (${CONVERT} "${FOLDER}/padded/large.obj" "${FOLDER}/lazy/large.stl" --lazy-vertices)
+
+file (SIZE "${FOLDER}/plain/large.stl" expected)
+
+file (READ "${FOLDER}/plain/large.stl" count OFFSET 80 LIMIT 4 HEX)
+
+string (SUBSTRING ${count} 0 2 b0)
+string (SUBSTRING ${count} 2 2 b1)
+string (SUBSTRING ${count} 4 2 b2)
+string (SUBSTRING ${count} 6 2 b3)
+
+math (EXPR triangles "0x${b3}${b2}${b1}${b0}") # Little-endian
+math (EXPR bytes "84 + 50 * ${triangles}")
+
+if (triangles EQUAL 0 OR NOT expected EQUAL bytes)
+  message (FATAL_ERROR "The header counts ${triangles} triangles in ${expected} bytes")
+endif()
+
+math (EXPR last "${expected} - 50")
+
+file (READ "${FOLDER}/plain/large.stl" face OFFSET ${last} LIMIT 50 HEX)
+
+foreach (kind padded lazy)
+  file (SIZE "${FOLDER}/${kind}/large.stl" written)
+
+  file (READ "${FOLDER}/${kind}/large.stl" header OFFSET 80 LIMIT 4 HEX)
+  file (READ "${FOLDER}/${kind}/large.stl" final OFFSET ${last} LIMIT 50 HEX)
+
+  if (NOT written EQUAL expected OR NOT header STREQUAL count)
+    message (FATAL_ERROR "${kind}: ${written} bytes and count ${header}, expected ${expected} bytes and count ${count}")
+  endif()
+
+  if (NOT final STREQUAL face)
+    message (FATAL_ERROR "${kind}: the last triangle differs")
+  endif()
+
+  execute_process (COMMAND ${CMAKE_COMMAND} -E compare_files "${FOLDER}/plain/large.stl" "${FOLDER}/${kind}/large.stl" RESULT_VARIABLE differs)
+
+  if (NOT differs EQUAL 0)
+    message (FATAL_ERROR "${kind}: the triangles differ from the source without padding")
+  endif()
+endforeach()
+
+file (REMOVE_RECURSE "${FOLDER}")
@@ -16,25 +16,92 @@
 
    (*) Best choice => triangulated file => c:\temp\lego.triangulated.obj
 
+	   --serve /tmp/triangulate.sock                                    (daemon, jobs from TriangulateOBJ_client)
+	   --watch c:\ingest [c:\converted]                                 (converts the obj files written to c:\ingest)
+	   --calibrate c:\temp\engines.txt                                 (then c:\temp\lego.obj --calibration c:\temp\engines.txt)
+
   --------------------------------------------------------------------------------------
 */
 
 #include <iostream>
 #include "cmd.h"
 #include "out.h"
+#include "srv.h"
+#include "dir.h"
+#include "cal.h"
 #include "TriangulateOBJ.h"
 
 using namespace std;
 
-int main(int argc, char* argv[])
+static obj::Selection selection; // Thresholds of the adaptive triangulation
+
+bool calibration() // The thresholds of --calibration, the built in ones otherwise
 {
-	obj::Triangulate obj;
+	selection = obj::Selection();
 
-	if( !arg(argc, argv) ) return 1;
+	if( calibration_file.empty() || selection.load(calibration_file.string()) ) return true;
+
+	std::cout << "Error: Could not read the calibration file " << calibration_file.string() << std::endl;
+
+	return false;
+}
+
+void configure(obj::Triangulate& obj) // The options of the arguments, every option is set since a daemon reuses obj
+{
+	if( progress_interval > 0.0 )
+		obj.progress(print_progress, progress_interval);
+	else
+		obj.progress(nullptr);
+
+	obj.incremental(incremental);
+
+	obj.lazy(lazy_vertices);
+
+	obj.budget(memory_budget);
+
+	obj.output(obj::Output::Obj);
+
+	if( ext(target) == "stl" ) obj.output(obj::Output::Stl);
+	if( ext(target) == "ply" ) obj.output(obj::Output::Ply);
+
+	if( weld_tolerance >= 0.0 )
+		obj.weld(true, static_cast<obj::Real>(weld_tolerance));
+	else
+		obj.weld(false);
+
+	obj.sort(obj::Sort::None);
+
+	if( sort_faces == "material" ) obj.sort(obj::Sort::Material);
+	if( sort_faces == "group" ) obj.sort(obj::Sort::Group);
+
+	obj.chunk(chunk_vertices, chunk_triangles);
+
+	obj.adapt(adaptive, selection);
+
+	obj.split(split_corners);
+
+	obj.map(mapped_output);
+
+	obj.io(io_backend == "uring" ? obj::Io::Uring : obj::Io::Stdio);
+}
+
+bool convert(obj::Triangulate& obj) // The files and options of the arguments
+{
+	if( !calibration() ) return false;
+
+	configure(obj);
+
+	obj::Trace trace;
+
+	obj.trace(trace_json.empty() ? nullptr : &trace);
 
 	const auto triangulated = obj.triangulate(source.string(), target.string());
 
-	if( triangulated )
+	obj.trace(nullptr);
+
+	if( obj.skipped() )
+		std::cout << source.string() << " is unchanged, " << target.string() << " is up to date" << std::endl;
+	else if( triangulated )
 		std::cout << source.string() << " has been triangulated" << std::endl;
 	else if( obj.empty() )
 		std::cout << source.string() << " can not be triangulated (no polygons)" << std::endl;
@@ -43,5 +110,27 @@ int main(int argc, char* argv[])
 
 	report(obj);
 
-	return triangulated ? 0 : 1;
+	if( !write_metrics(obj, triangulated) ) return false;
+
+	if( !trace_json.empty() && !trace.write(trace_json.string()) ) return false;
+
+	return triangulated;
+}
+
+int main(int argc, char* argv[])
+{
+	obj::Triangulate obj;
+
+	if( !arg(argc, argv) ) return 1;
+
+	if( !calibrate_file.empty() )
+		return calibrate(calibrate_file.string()) ? 0 : 1;
+
+	if( !watch_folder.empty() )
+		return calibration() && watch(watch_folder, watch_target, watch_jobs, watch_debounce, configure) ? 0 : 1;
+
+	if( !serve_socket.empty() )
+		return serve(serve_socket, obj, [&] { return convert(obj); }) ? 0 : 1;
+
+	return convert(obj) ? 0 : 1;
 }
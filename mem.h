@@ -0,0 +1,211 @@
+#pragma once
+/*
+  mem.h - Helper class for memory accounting
+
+  NB: TriangulateOBJ.h has no dependencies to this file, only main.cpp is using it.
+
+  With TRIANGULATE_COUNT_ALLOCATIONS defined this header replaces the global
+  operator new and delete, the over-aligned forms too, with versions that count
+  allocations, allocated bytes and the peak of live heap bytes. The replacements
+  are not inline, so the header must be included by one translation unit only.
+
+  Copyright (c) 2023 FalconCoding
+
+  This software is released under the terms of the
+  GNU General Public License v3.0. Details and terms of this
+  license can be found at: https://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#include <new>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+struct Memory
+{
+	bool counted = false; // False when the counting allocator is not compiled in
+
+	uint64_t allocations = 0;
+	uint64_t bytes       = 0; // Total bytes allocated
+	uint64_t live        = 0; // Bytes allocated and not yet freed
+	uint64_t peak        = 0; // Peak of live bytes
+};
+
+namespace mem
+{
+	static std::atomic<uint64_t> allocations{0};
+	static std::atomic<uint64_t> bytes{0};
+	static std::atomic<uint64_t> live{0};
+	static std::atomic<uint64_t> peak{0};
+}
+
+inline Memory memory()
+{
+	Memory memory;
+
+#ifdef TRIANGULATE_COUNT_ALLOCATIONS
+	memory.counted = true;
+#endif
+
+	memory.allocations = mem::allocations.load(std::memory_order_relaxed);
+	memory.bytes       = mem::bytes.load(std::memory_order_relaxed);
+	memory.live        = mem::live.load(std::memory_order_relaxed);
+	memory.peak        = mem::peak.load(std::memory_order_relaxed);
+
+	return memory;
+}
+
+inline size_t peak_memory() // Peak resident set size in bytes
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+
+	if( !GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof counters) )
+		return 0;
+
+	return counters.PeakWorkingSetSize;
+#else
+	struct rusage usage;
+
+	if( getrusage(RUSAGE_SELF, &usage) != 0 )
+		return 0;
+
+#ifdef __APPLE__
+	return static_cast<size_t>(usage.ru_maxrss);
+#else
+	return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+#ifdef TRIANGULATE_COUNT_ALLOCATIONS
+
+#ifdef _MSC_VER
+#define MEM_NOINLINE __declspec(noinline)
+#else
+#define MEM_NOINLINE __attribute__((noinline))
+#endif
+
+namespace mem
+{
+	struct Prefix // Just before every returned pointer
+	{
+		size_t size;
+
+		void* block; // From malloc(), apart from the pointer when over-aligned
+	};
+
+	constexpr size_t header = alignof(std::max_align_t) < sizeof(Prefix) ? sizeof(Prefix) : alignof(std::max_align_t); // Keeps the returned pointer aligned
+
+	// Not inlined, so the compiler does not see the replaced operator delete free() a pointer behind the one operator new returned
+
+	MEM_NOINLINE inline void* allocate(const size_t size, const size_t align = alignof(std::max_align_t))
+	{
+		const auto extra = align > alignof(std::max_align_t) ? align : 0;
+
+		auto* block = static_cast<unsigned char*>(std::malloc(size + header + extra));
+
+		if( block == nullptr ) return nullptr;
+
+		auto* pointer = block + header;
+
+		if( extra != 0 )
+			pointer += (align - reinterpret_cast<uintptr_t>(pointer) % align) % align;
+
+		*(reinterpret_cast<Prefix*>(pointer) - 1) = Prefix{size, block};
+
+		allocations.fetch_add(1, std::memory_order_relaxed);
+		bytes.fetch_add(size, std::memory_order_relaxed);
+
+		const auto now = live.fetch_add(size, std::memory_order_relaxed) + size;
+
+		auto high = peak.load(std::memory_order_relaxed);
+
+		while( now > high && !peak.compare_exchange_weak(high, now, std::memory_order_relaxed) ) {}
+
+		return pointer;
+	}
+
+	MEM_NOINLINE inline void release(void* pointer)
+	{
+		if( pointer == nullptr ) return;
+
+		const auto prefix = *(static_cast<Prefix*>(pointer) - 1);
+
+		live.fetch_sub(prefix.size, std::memory_order_relaxed);
+
+		std::free(prefix.block);
+	}
+}
+
+void* operator new(const size_t size)
+{
+	if( void* pointer = mem::allocate(size) ) return pointer;
+
+	throw std::bad_alloc();
+}
+
+void* operator new[](const size_t size)
+{
+	if( void* pointer = mem::allocate(size) ) return pointer;
+
+	throw std::bad_alloc();
+}
+
+void* operator new(const size_t size, const std::nothrow_t&) noexcept { return mem::allocate(size); }
+
+void* operator new[](const size_t size, const std::nothrow_t&) noexcept { return mem::allocate(size); }
+
+void* operator new(const size_t size, const std::align_val_t align) // Over-aligned types, as alignas(64) members
+{
+	if( void* pointer = mem::allocate(size, static_cast<size_t>(align)) ) return pointer;
+
+	throw std::bad_alloc();
+}
+
+void* operator new[](const size_t size, const std::align_val_t align)
+{
+	if( void* pointer = mem::allocate(size, static_cast<size_t>(align)) ) return pointer;
+
+	throw std::bad_alloc();
+}
+
+void* operator new(const size_t size, const std::align_val_t align, const std::nothrow_t&) noexcept { return mem::allocate(size, static_cast<size_t>(align)); }
+
+void* operator new[](const size_t size, const std::align_val_t align, const std::nothrow_t&) noexcept { return mem::allocate(size, static_cast<size_t>(align)); }
+
+void operator delete(void* pointer) noexcept { mem::release(pointer); }
+
+void operator delete[](void* pointer) noexcept { mem::release(pointer); }
+
+void operator delete(void* pointer, size_t) noexcept { mem::release(pointer); }
+
+void operator delete[](void* pointer, size_t) noexcept { mem::release(pointer); }
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { mem::release(pointer); }
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { mem::release(pointer); }
+
+void operator delete(void* pointer, std::align_val_t) noexcept { mem::release(pointer); }
+
+void operator delete[](void* pointer, std::align_val_t) noexcept { mem::release(pointer); }
+
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { mem::release(pointer); }
+
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { mem::release(pointer); }
+
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { mem::release(pointer); }
+
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { mem::release(pointer); }
+
+#endif
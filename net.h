@@ -0,0 +1,309 @@
+#pragma once
+/*
+  net.h - Unix domain socket helpers for the daemon mode (srv.h) and its client (client.cpp)
+
+  NB: TriangulateOBJ.h has no dependencies to this file.
+
+  A request is a header line, the working directory of the client, the arguments
+  of a command line (one per line) and, for an inline source, the bytes of the
+  source itself:
+
+      job <arguments> <inline bytes>\n
+      <directory>\n
+      <argument>\n ...
+      <inline bytes of obj source>
+
+  or a single "stop\n" that shuts the daemon down. The answer carries the metrics
+  JSON and the text the conversion printed:
+
+      ok|failed <metrics bytes> <log bytes>\n
+      <metrics><log>
+
+  Copyright (c) 2023 FalconCoding
+
+  This software is released under the terms of the
+  GNU General Public License v3.0. Details and terms of this
+  license can be found at: https://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#ifndef _WIN32
+
+#include <string>
+#include <vector>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+#include <unistd.h>
+#include <sys/un.h>
+#include <sys/socket.h>
+
+namespace net
+{
+	constexpr size_t MAX_LINE      = 64 << 10;
+	constexpr size_t MAX_ARGUMENTS = 256;
+
+	struct Request
+	{
+		bool stop = false;
+
+		std::string directory; // Relative paths in the arguments are relative to this
+
+		std::vector<std::string> arguments; // Without the program name
+
+		std::string source; // Inline source, empty when the arguments name the source file
+	};
+
+	struct Response
+	{
+		bool ok = false; // Triangulated, or skipped as up to date
+
+		std::string metrics; // Empty when the arguments were rejected
+		std::string log;     // Everything the conversion printed
+	};
+
+	class Stream // Buffered reads and whole writes on a connected socket, the socket stays open
+	{
+	public:
+
+		explicit Stream(const int fd) : fd(fd) {}
+
+		bool line(std::string& text) // Up to the line ending, without it
+		{
+			text.clear();
+
+			while( true )
+			{
+				const auto end = buffer.find('\n', start);
+
+				if( end != std::string::npos )
+				{
+					text.assign(buffer, start, end - start);
+
+					start = end + 1;
+
+					return true;
+				}
+
+				if( buffer.size() - start > MAX_LINE || !fill() ) return false;
+			}
+		}
+
+		bool read(std::string& text, const size_t bytes)
+		{
+			text.clear();
+
+			while( true )
+			{
+				const auto take = std::min(bytes - text.size(), buffer.size() - start);
+
+				text.append(buffer, start, take);
+
+				start += take;
+
+				if( text.size() == bytes ) return true;
+
+				if( !fill() ) return false;
+			}
+		}
+
+		bool write(const std::string& text)
+		{
+			size_t done(0);
+
+			while( done < text.size() )
+			{
+				const auto sent = ::send(fd, text.data() + done, text.size() - done, 0);
+
+				if( sent < 0 && errno == EINTR ) continue;
+
+				if( sent <= 0 ) return false;
+
+				done += static_cast<size_t>(sent);
+			}
+
+			return true;
+		}
+
+	private:
+
+		bool fill()
+		{
+			if( start == buffer.size() )
+			{
+				buffer.clear();
+
+				start = 0;
+			}
+
+			char block[64 << 10];
+
+			while( true )
+			{
+				const auto received = ::recv(fd, block, sizeof block, 0);
+
+				if( received < 0 && errno == EINTR ) continue;
+
+				if( received <= 0 ) return false;
+
+				buffer.append(block, static_cast<size_t>(received));
+
+				return true;
+			}
+		}
+
+		const int fd;
+
+		std::string buffer;
+
+		size_t start = 0;
+	};
+
+	inline bool address(const std::string& path, sockaddr_un& socket)
+	{
+		memset(&socket, 0, sizeof socket);
+
+		socket.sun_family = AF_UNIX;
+
+		if( path.empty() || path.size() >= sizeof socket.sun_path ) return false;
+
+		memcpy(socket.sun_path, path.c_str(), path.size() + 1);
+
+		return true;
+	}
+
+	inline int listen(const std::string& path) // -1 on failure, a stale socket file is replaced
+	{
+		sockaddr_un socket;
+
+		if( !address(path, socket) ) return -1;
+
+		const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+		if( fd < 0 ) return -1;
+
+		unlink(path.c_str());
+
+		if( ::bind(fd, reinterpret_cast<const sockaddr*>(&socket), sizeof socket) != 0 || ::listen(fd, 64) != 0 )
+		{
+			::close(fd);
+
+			return -1;
+		}
+
+		return fd;
+	}
+
+	inline int connect(const std::string& path) // -1 on failure
+	{
+		sockaddr_un socket;
+
+		if( !address(path, socket) ) return -1;
+
+		const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+		if( fd < 0 ) return -1;
+
+		if( ::connect(fd, reinterpret_cast<const sockaddr*>(&socket), sizeof socket) != 0 )
+		{
+			::close(fd);
+
+			return -1;
+		}
+
+		return fd;
+	}
+
+	inline bool number(const std::string& text, size_t& value)
+	{
+		char* end = nullptr;
+
+		value = std::strtoull(text.c_str(), &end, 10);
+
+		return !text.empty() && *end == '\0';
+	}
+
+	inline bool send(Stream& stream, const Request& request)
+	{
+		if( request.stop ) return stream.write("stop\n");
+
+		std::string text = "job " + std::to_string(request.arguments.size()) + " " + std::to_string(request.source.size()) + "\n";
+
+		text += request.directory + "\n";
+
+		for( const auto& argument : request.arguments )
+			text += argument + "\n";
+
+		return stream.write(text) && stream.write(request.source);
+	}
+
+	inline bool receive(Stream& stream, Request& request)
+	{
+		request = Request();
+
+		std::string line;
+
+		if( !stream.line(line) ) return false;
+
+		if( line == "stop" )
+		{
+			request.stop = true;
+
+			return true;
+		}
+
+		size_t arguments(0), bytes(0);
+
+		const auto space = line.find(' ', 4);
+
+		if( line.rfind("job ", 0) != 0 || space == std::string::npos ) return false;
+
+		if( !number(line.substr(4, space - 4), arguments) || !number(line.substr(space + 1), bytes) || arguments > MAX_ARGUMENTS ) return false;
+
+		if( !stream.line(request.directory) ) return false;
+
+		request.arguments.resize(arguments);
+
+		for( auto& argument : request.arguments )
+		{
+			if( !stream.line(argument) ) return false;
+		}
+
+		return stream.read(request.source, bytes);
+	}
+
+	inline bool send(Stream& stream, const Response& response)
+	{
+		const std::string head = std::string(response.ok ? "ok " : "failed ") + std::to_string(response.metrics.size()) + " " + std::to_string(response.log.size()) + "\n";
+
+		return stream.write(head + response.metrics + response.log);
+	}
+
+	inline bool receive(Stream& stream, Response& response)
+	{
+		response = Response();
+
+		std::string line;
+
+		if( !stream.line(line) ) return false;
+
+		const auto first  = line.find(' ');
+		const auto second = first == std::string::npos ? first : line.find(' ', first + 1);
+
+		if( first == std::string::npos || second == std::string::npos ) return false;
+
+		const auto status = line.substr(0, first);
+
+		size_t metrics(0), log(0);
+
+		if( (status != "ok" && status != "failed") || !number(line.substr(first + 1, second - first - 1), metrics) || !number(line.substr(second + 1), log) ) return false;
+
+		response.ok = status == "ok";
+
+		return stream.read(response.metrics, metrics) && stream.read(response.log, log);
+	}
+}
+
+#endif
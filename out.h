@@ -16,11 +16,16 @@
 
 #include <string>
 #include <chrono>
+#include <iomanip>
+#include <fstream>
 #include <sstream>
 #include <iostream>
 
+#include <sys/stat.h>
+
 #include "cmd.h"
 #include "div.h"
+#include "mem.h"
 
 #include "TriangulateOBJ.h"
 
@@ -30,10 +35,27 @@ using Clock = std::chrono::high_resolution_clock;
 
 static std::chrono::time_point<Clock> init;
 
+static Memory heap; // Heap counters at launch
+
 std::string stopwatch();
 
+std::string stopwatch(const std::chrono::microseconds&);
+
+inline std::chrono::microseconds seconds(const double time)
+{
+	return std::chrono::microseconds(static_cast<long long>(time * 1e6));
+}
+
 std::string file_size_info();
 
+size_t file_bytes(const Path&);
+
+std::string byte_text(const size_t&);
+
+Memory heap_usage();
+
+std::string json_text(const std::string&);
+
 inline void report(const obj::Triangulate& obj)
 {
 	constexpr int n(60);
@@ -51,6 +73,16 @@ inline void report(const obj::Triangulate& obj)
 	std::cout << indent << target.filename().string() << " " << file_size_info() << std::endl;
 	std::cout << indent << std::string(n, '-') << std::endl;
 	std::cout << indent << "Vertices              : " << std::setw(10) << v << std::endl;
+
+	if( obj.metrics().welded > 0 )
+	{
+		std::ostringstream ratio;
+
+		ratio << std::fixed << std::setprecision(1) << 100.0 * static_cast<double>(obj.metrics().welded) / static_cast<double>(v) << "%";
+
+		std::cout << indent << "Vertices     (welded) : " << std::setw(10) << obj.metrics().welded << "     (" << ratio.str() << ")" << std::endl;
+	}
+
 	std::cout << indent << std::string(n, '-') << std::endl;
 	std::cout << indent << "Triangles             : " << std::setw(10) << t.first << std::endl;
 	std::cout << indent << "Polygons              : " << std::setw(10) << p.first << std::endl;
@@ -58,11 +90,119 @@ inline void report(const obj::Triangulate& obj)
 	std::cout << indent << "Triangles    (after)  : " << std::setw(10) << t.first + t.second << "     (+" << t.second << ")" << std::endl;
 	std::cout << indent << "Polygons     (after)  : " << std::setw(10) << p.first - p.second << std::endl;
 	std::cout << indent << std::string(n, '-') << std::endl;
+
+	const auto m = obj.metrics().materials;
+
+	if( m.first > 0 )
+	{
+		std::cout << indent << "Material switches     : " << std::setw(10) << m.first << std::endl;
+		std::cout << indent << "Material sw. (after)  : " << std::setw(10) << m.second << "     (-" << m.first - std::min(m.first, m.second) << ")" << std::endl;
+		std::cout << indent << std::string(n, '-') << std::endl;
+	}
+
+	const auto& c = obj.metrics();
+
+	if( c.chunks > 0 )
+	{
+		const auto unique = c.chunkVertices - c.duplicated;
+
+		std::ostringstream average, ratio;
+
+		average << std::fixed << std::setprecision(1) << static_cast<double>(c.chunkVertices) / static_cast<double>(c.chunks);
+		ratio << std::fixed << std::setprecision(1) << (unique > 0 ? 100.0 * static_cast<double>(c.duplicated) / static_cast<double>(unique) : 0.0) << "%";
+
+		std::cout << indent << "Chunks                : " << std::setw(10) << c.chunks << "     (" << average.str() << " vertices each)" << std::endl;
+		std::cout << indent << "Vertices (duplicated) : " << std::setw(10) << c.duplicated << "     (" << ratio.str() << ")" << std::endl;
+		std::cout << indent << std::string(n, '-') << std::endl;
+	}
+
+	if( obj.profile().divided > 0 )
+	{
+		std::cout << indent << "Polygons    (divided) : " << std::setw(10) << obj.profile().divided << "     (" << obj.profile().pieces << " pieces)" << std::endl;
+		std::cout << indent << std::string(n, '-') << std::endl;
+	}
+
 	std::cout << indent << "Execution time        : " << stopwatch() << std::endl;
+	std::cout << indent << std::string(n, '-') << std::endl;
+
+	const auto& profile = obj.profile();
+
+	for( int phase = 0; phase < obj::Profile::Phases; phase++ )
+	{
+		const auto name = obj::Profile::name(static_cast<obj::Profile::Phase>(phase));
+
+		std::cout << indent << std::setw(22) << std::left << name << std::right << ": " << stopwatch(seconds(profile.seconds[phase]));
+
+		if( phase == obj::Profile::Triangulation || phase == obj::Profile::Format )
+			std::cout << "  (all workers)";
+
+		std::cout << std::endl;
+	}
+
+	std::cout << indent << std::string(n, '-') << std::endl;
+	std::cout << indent << "Face corners          :      Faces   Time" << std::endl;
+
+	size_t low(2);
+
+	for( const auto& bucket : profile.histogram )
+	{
+		const auto range = bucket.corners == SIZE_MAX ? std::to_string(low + 1) + "+" : low + 1 == bucket.corners ? std::to_string(bucket.corners) : std::to_string(low + 1) + " - " + std::to_string(bucket.corners);
+
+		low = bucket.corners;
+
+		if( bucket.faces == 0 ) continue;
+
+		std::cout << indent << std::setw(22) << std::left << range << std::right << ": " << std::setw(10) << bucket.faces << "   " << stopwatch(seconds(bucket.seconds)) << std::endl;
+	}
+
+	std::cout << indent << std::string(n, '-') << std::endl;
+
+	for( size_t id = 0; id < obj.workers().size(); id++ )
+	{
+		const auto& worker = obj.workers()[id];
+
+		std::cout << indent << "Worker " << std::setw(3) << std::left << id << std::right << " busy       : " << stopwatch(seconds(worker.busy));
+		std::cout << "  (tasks " << worker.tasks << ", steals " << worker.steals << ")" << std::endl;
+	}
+
+	std::cout << indent << std::string(n, '-') << std::endl;
+	std::cout << indent << "Peak memory (RSS)     : " << std::setw(10) << byte_text(peak_memory()) << std::endl;
+	std::cout << indent << "Vertex storage        : " << std::setw(10) << byte_text(profile.vertexBytes) << std::endl;
+
+	if( profile.vertexFileBytes > 0 )
+		std::cout << indent << "Vertex file           : " << std::setw(10) << byte_text(static_cast<size_t>(profile.vertexFileBytes)) << "     (" << profile.vertexLoads << " blocks read back)" << std::endl;
+	std::cout << indent << "Batch buffers         : " << std::setw(10) << byte_text(profile.batchBytes) << std::endl;
+
+	if( profile.mappedWindows > 0 )
+		std::cout << indent << "Mapped output         : " << std::setw(10) << byte_text(static_cast<size_t>(profile.mappedBytes)) << "     (" << profile.mappedWindows << " windows)" << std::endl;
+
+	if( profile.ringReads + profile.ringWrites > 0 )
+		std::cout << indent << "io_uring reads        : " << std::setw(10) << profile.ringReads << "     (" << profile.ringWrites << " writes)" << std::endl;
+
+	const auto usage = heap_usage();
+
+	if( usage.counted )
+	{
+		const auto faces = t.first + p.first;
+
+		std::ostringstream perFace;
+
+		perFace << std::fixed << std::setprecision(1) << (faces > 0 ? static_cast<double>(usage.allocations) / static_cast<double>(faces) : 0.0);
+
+		std::cout << indent << "Heap allocations      : " << std::setw(10) << usage.allocations << "     (" << byte_text(usage.bytes) << ")" << std::endl;
+		std::cout << indent << "Heap peak             : " << std::setw(10) << byte_text(usage.peak) << std::endl;
+		std::cout << indent << "Allocations per face  : " << std::setw(10) << perFace.str() << std::endl;
+	}
+
 	std::cout << indent << std::string(n, '-') << std::endl << std::endl;
 }
 
 inline std::string stopwatch(const std::chrono::time_point<Clock>& time, const std::chrono::time_point<Clock>& stop)
+{
+	return stopwatch(std::chrono::duration_cast<std::chrono::microseconds>(stop - time));
+}
+
+inline std::string stopwatch(const std::chrono::microseconds& duration)
 {
 	using Seconds = std::chrono::seconds;
 	using Minutes = std::chrono::minutes;
@@ -70,8 +210,6 @@ inline std::string stopwatch(const std::chrono::time_point<Clock>& time, const s
 	using MilliSeconds = std::chrono::milliseconds;
 	using MicroSeconds = std::chrono::microseconds;
 
-	const auto duration = std::chrono::duration_cast<MicroSeconds>(stop - time);
-
 	const auto hours        = std::chrono::duration_cast<Hours>(duration);
 	const auto minutes      = std::chrono::duration_cast<Minutes>(duration % Hours(1));
 	const auto seconds      = std::chrono::duration_cast<Seconds>(duration % Minutes(1));
@@ -99,6 +237,17 @@ inline std::string stopwatch(const std::chrono::time_point<Clock>& time, const s
 inline void launch()
 {
 	init = Clock::now();
+	heap = memory();
+}
+
+inline Memory heap_usage() // Heap counters since launch, the peak is the absolute peak of live bytes
+{
+	auto usage = memory();
+
+	usage.allocations -= heap.allocations;
+	usage.bytes       -= heap.bytes;
+
+	return usage;
 }
 
 inline std::string stopwatch()
@@ -106,8 +255,6 @@ inline std::string stopwatch()
 	return stopwatch(init, Clock::now());
 }
 
-inline std::string byte_text(const size_t&);
-
 inline std::string file_size()
 {
 	struct stat st;
@@ -165,3 +312,193 @@ inline std::string byte_text(const size_t& byte)
 	return result.str();
 }
 
+inline size_t file_bytes(const Path& path)
+{
+	struct stat st;
+
+	if( stat(path.string().c_str(), &st) != 0 )
+		return 0;
+
+	return static_cast<size_t>(st.st_size);
+}
+
+inline std::string json_text(const std::string& text)
+{
+	std::string result = "\"";
+
+	for( const auto& c : text )
+	{
+		switch( c )
+		{
+		case '"':result += "\\\""; break;
+		case '\\':result += "\\\\"; break;
+		case '\n':result += "\\n"; break;
+		case '\r':result += "\\r"; break;
+		case '\t':result += "\\t"; break;
+		default:
+			if( static_cast<unsigned char>(c) < 0x20 )
+			{
+				char code[8];
+
+				snprintf(code, sizeof code, "\\u%04x", c);
+
+				result += code;
+			}
+			else
+				result += c;
+		}
+	}
+
+	return result + "\"";
+}
+
+inline std::string metrics_text(const obj::Triangulate& obj, const bool triangulated)
+{
+	const auto seconds = std::chrono::duration<double>(Clock::now() - init).count();
+
+	const auto& count   = obj.metrics();
+	const auto& profile = obj.profile();
+
+	const auto sourceBytes = file_bytes(source);
+	const auto targetBytes = file_bytes(target);
+
+	const auto faces = count.triangles.first + count.polygons.first;
+
+	const auto rate = [&](const double value) { return seconds > 0.0 ? value / seconds : 0.0; };
+
+	std::ostringstream text;
+
+	text.imbue(std::locale::classic());
+
+	text << std::fixed << std::setprecision(6);
+
+	text << "{\n";
+	text << "  \"triangulated\": " << (triangulated ? "true" : "false") << ",\n";
+	text << "  \"skipped\": " << (obj.skipped() ? "true" : "false") << ",\n";
+	text << "  \"source\": {\"file\": " << json_text(source.string()) << ", \"bytes\": " << sourceBytes << ", \"ring_reads\": " << profile.ringReads << "},\n";
+	text << "  \"target\": {\"file\": " << json_text(target.string()) << ", \"bytes\": " << targetBytes << ", \"mapped_bytes\": " << profile.mappedBytes << ", \"ring_writes\": " << profile.ringWrites << "},\n";
+	text << "  \"count\": {\n";
+	text << "    \"vertices\": " << count.vertices << ",\n";
+	text << "    \"vertices_welded\": " << count.welded << ",\n";
+	text << "    \"weld_ratio\": " << (count.vertices > 0 ? static_cast<double>(count.welded) / static_cast<double>(count.vertices) : 0.0) << ",\n";
+	text << "    \"polygons\": " << count.polygons.first << ",\n";
+	text << "    \"polygons_triangulated\": " << count.polygons.second << ",\n";
+	text << "    \"polygons_after\": " << count.polygons.first - count.polygons.second << ",\n";
+	text << "    \"triangles\": " << count.triangles.first << ",\n";
+	text << "    \"triangles_written\": " << count.triangles.second << ",\n";
+	text << "    \"triangles_after\": " << count.triangles.first + count.triangles.second << ",\n";
+	text << "    \"material_switches\": " << count.materials.first << ",\n";
+	text << "    \"material_switches_after\": " << count.materials.second << ",\n";
+	text << "    \"chunks\": " << count.chunks << ",\n";
+	text << "    \"chunk_vertices\": " << count.chunkVertices << ",\n";
+	text << "    \"chunk_vertices_duplicated\": " << count.duplicated << ",\n";
+	text << "    \"polygons_divided\": " << profile.divided << ",\n";
+	text << "    \"divided_pieces\": " << profile.pieces << "\n";
+	text << "  },\n";
+	text << "  \"seconds\": {\n";
+	text << "    \"total\": " << seconds;
+
+	for( int phase = 0; phase < obj::Profile::Phases; phase++ )
+	{
+		std::string name = obj::Profile::name(static_cast<obj::Profile::Phase>(phase));
+
+		std::transform(name.begin(), name.end(), name.begin(), [](const char c) { return c == ' ' ? '_' : static_cast<char>(::tolower(c)); });
+
+		text << ",\n    " << json_text(name) << ": " << profile.seconds[phase];
+	}
+
+	text << "\n  },\n";
+	text << "  \"histogram\": [";
+
+	for( size_t index = 0; index < profile.histogram.size(); index++ )
+	{
+		const auto& bucket = profile.histogram[index];
+
+		text << (index == 0 ? "\n" : ",\n") << "    {\"corners_max\": ";
+
+		if( bucket.corners == SIZE_MAX ) text << "null"; else text << bucket.corners;
+
+		text << ", \"faces\": " << bucket.faces << ", \"seconds\": " << bucket.seconds << "}";
+	}
+
+	text << "\n  ],\n";
+	text << "  \"workers\": [";
+
+	for( size_t id = 0; id < obj.workers().size(); id++ )
+	{
+		const auto& worker = obj.workers()[id];
+
+		text << (id == 0 ? "\n" : ",\n") << "    {\"busy_seconds\": " << worker.busy << ", \"tasks\": " << worker.tasks << ", \"steals\": " << worker.steals << "}";
+	}
+
+	text << "\n  ],\n";
+	text << "  \"throughput\": {\n";
+	text << "    \"source_mb_per_second\": " << rate(static_cast<double>(sourceBytes) / 1048576.0) << ",\n";
+	text << "    \"target_mb_per_second\": " << rate(static_cast<double>(targetBytes) / 1048576.0) << ",\n";
+	text << "    \"faces_per_second\": " << rate(static_cast<double>(faces)) << "\n";
+	text << "  },\n";
+	const auto usage = heap_usage();
+
+	text << "  \"memory\": {\n";
+	text << "    \"peak_rss_bytes\": " << peak_memory() << ",\n";
+	text << "    \"vertex_bytes\": " << profile.vertexBytes << ",\n";
+	text << "    \"vertex_file_bytes\": " << profile.vertexFileBytes << ",\n";
+	text << "    \"vertex_block_loads\": " << profile.vertexLoads << ",\n";
+	text << "    \"batch_bytes\": " << profile.batchBytes << ",\n";
+	text << "    \"heap_counted\": " << (usage.counted ? "true" : "false");
+
+	if( usage.counted )
+	{
+		text << ",\n    \"heap_allocations\": " << usage.allocations << ",\n";
+		text << "    \"heap_bytes\": " << usage.bytes << ",\n";
+		text << "    \"heap_peak_bytes\": " << usage.peak << ",\n";
+		text << "    \"allocations_per_face\": " << (faces > 0 ? static_cast<double>(usage.allocations) / static_cast<double>(faces) : 0.0);
+	}
+
+	text << "\n  }\n";
+	text << "}\n";
+
+	return text.str();
+}
+
+inline bool write_metrics(const obj::Triangulate& obj, const bool triangulated)
+{
+	if( metrics_json.empty() ) return true;
+
+	std::ofstream file(metrics_json);
+
+	if( !file )
+	{
+		std::cout << "Error: Could not open the metrics file " << metrics_json.string() << std::endl;
+
+		return false;
+	}
+
+	file << metrics_text(obj, triangulated);
+
+	return static_cast<bool>(file);
+}
+
+inline void print_progress(const obj::Progress& progress)
+{
+	const auto elapsed = std::max(progress.seconds, 1e-9);
+
+	const auto bytesPerSecond = static_cast<double>(progress.bytes) / elapsed;
+	const auto facesPerSecond = static_cast<double>(progress.faces) / elapsed;
+
+	std::ostringstream line;
+
+	line.imbue(std::locale(std::locale(), new thousandsFacet));
+
+	line << indent << std::fixed << std::setprecision(1) << std::setw(5) << progress.fraction() * 100.0 << "%  ";
+	line << byte_text(progress.bytes) << " / " << byte_text(progress.total) << "  ";
+	line << std::setprecision(0) << facesPerSecond << " faces/s  ";
+	line << std::setprecision(1) << bytesPerSecond / 1048576.0 << " MB/s  ";
+
+	if( progress.done )
+		line << "done in " << stopwatch(seconds(progress.seconds));
+	else if( bytesPerSecond > 0.0 )
+		line << "ETA " << stopwatch(seconds(static_cast<double>(progress.total - std::min(progress.total, progress.bytes)) / bytesPerSecond));
+
+	std::cout << line.str() << std::endl;
+}
@@ -1,3 +1,7 @@
+newoption { trigger = "count-allocations", description = "Count heap allocations in TriangulateOBJ" }
+newoption { trigger = "index-32", description = "Use 32-bit face indices in TriangulateOBJ" }
+newoption { trigger = "double", description = "Use double coordinates in TriangulateOBJ" }
+
 workspace "TriangulateOBJ"
     configurations { "Debug", "Release" }
     platforms { "x86", "x64" }
@@ -12,6 +16,12 @@ workspace "TriangulateOBJ"
         defines { "NDEBUG" }
         optimize "On"
 
+    filter { "options:index-32" }
+        defines { "TRIANGULATE_INDEX_32" }
+
+    filter { "options:double" }
+        defines { "TRIANGULATE_DOUBLE" }
+
 project "TriangulateOBJ"
     kind "ConsoleApp"
     language "C++"
@@ -20,18 +30,113 @@ project "TriangulateOBJ"
     targetdir "%{wks.location}/bin/%{cfg.buildcfg}/%{cfg.platform}"
     objdir "%{wks.location}/obj/%{cfg.buildcfg}/%{cfg.platform}"
 
-    files {"**.h", "**.cpp" }
+    files { "main.cpp", "*.h" }
 
 	defines "_CRT_SECURE_NO_WARNINGS"
 
+    filter { "system:linux" }
+        links { "pthread" }
+        defines { "_FILE_OFFSET_BITS=64" }
+
     filter { "configurations:Debug" }
         targetname "TriangulateOBJ"
 
     filter { "configurations:Release" }
         targetname "TriangulateOBJ"
 
+    filter { "options:count-allocations" }
+        defines { "TRIANGULATE_COUNT_ALLOCATIONS" }
+
+    filter { "platforms:x86" }
+        architecture "x86"
+
+    filter { "platforms:x64" }
+        architecture "x64"
+
+project "TriangulateOBJ_bench"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++17"
+
+    targetdir "%{wks.location}/bin/%{cfg.buildcfg}/%{cfg.platform}"
+    objdir "%{wks.location}/obj/%{cfg.buildcfg}/%{cfg.platform}"
+
+    files { "bench.cpp", "shape.h", "TriangulateOBJ.h" }
+
+	defines "_CRT_SECURE_NO_WARNINGS"
+
+    filter { "system:linux" }
+        links { "pthread" }
+        defines { "_FILE_OFFSET_BITS=64" }
+
+    filter { "platforms:x86" }
+        architecture "x86"
+
+    filter { "platforms:x64" }
+        architecture "x64"
+
+project "TriangulateOBJ_generate"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++17"
+
+    targetdir "%{wks.location}/bin/%{cfg.buildcfg}/%{cfg.platform}"
+    objdir "%{wks.location}/obj/%{cfg.buildcfg}/%{cfg.platform}"
+
+    files { "generate.cpp", "shape.h", "TriangulateOBJ.h" }
+
+	defines "_CRT_SECURE_NO_WARNINGS"
+
+    filter { "system:linux" }
+        links { "pthread" }
+        defines { "_FILE_OFFSET_BITS=64" }
+
+    filter { "platforms:x86" }
+        architecture "x86"
+
+    filter { "platforms:x64" }
+        architecture "x64"
+
+project "TriangulateOBJ_validate"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++17"
+
+    targetdir "%{wks.location}/bin/%{cfg.buildcfg}/%{cfg.platform}"
+    objdir "%{wks.location}/obj/%{cfg.buildcfg}/%{cfg.platform}"
+
+    files { "validate.cpp", "shape.h", "TriangulateOBJ.h" }
+
+	defines { "_CRT_SECURE_NO_WARNINGS", "OBJ_FILES=\"%{wks.location}/../ObjFiles\"" }
+
+    filter { "system:linux" }
+        links { "pthread" }
+        defines { "_FILE_OFFSET_BITS=64" }
+
+    filter { "platforms:x86" }
+        architecture "x86"
+
+    filter { "platforms:x64" }
+        architecture "x64"
+
+project "TriangulateOBJ_client"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++17"
+
+    targetdir "%{wks.location}/bin/%{cfg.buildcfg}/%{cfg.platform}"
+    objdir "%{wks.location}/obj/%{cfg.buildcfg}/%{cfg.platform}"
+
+    files { "client.cpp", "net.h" }
+
+	defines "_CRT_SECURE_NO_WARNINGS"
+
+    filter { "system:linux" }
+        links { "pthread" }
+        defines { "_FILE_OFFSET_BITS=64" }
+
     filter { "platforms:x86" }
         architecture "x86"
 
     filter { "platforms:x64" }
-        architecture "x64"
\ No newline at end of file
+        architecture "x64"
@@ -0,0 +1,261 @@
+#pragma once
+
+/*
+  shape.h - Polygon generators for bench.cpp + generate.cpp + validate.cpp + cal.h
+
+  NB: TriangulateOBJ.h has no dependencies to this file.
+
+  All shapes are simple polygons in the xy-plane, counter-clockwise, with
+  Point::i set to the corner number so results can be traced back to corners.
+*/
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include "TriangulateOBJ.h"
+
+namespace shape
+{
+	class Random // splitmix64, identical sequence on every platform
+	{
+	public:
+
+		explicit Random(const uint64_t seed) : state(seed) {}
+
+		uint64_t next()
+		{
+			uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+
+			return z ^ (z >> 31);
+		}
+
+		double real() { return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0); }
+
+		size_t range(const size_t a, const size_t b) { return a + static_cast<size_t>(next() % (b - a + 1)); }
+
+	private:
+
+		uint64_t state;
+	};
+
+	enum class Kind
+	{
+		Convex,
+		Star,
+		Spiral,
+		Comb,
+		Zigzag
+	};
+
+	static const Kind kinds[] = {Kind::Convex, Kind::Star, Kind::Spiral, Kind::Comb, Kind::Zigzag};
+
+	inline std::string name(const Kind kind)
+	{
+		switch( kind )
+		{
+		case Kind::Convex:return "convex";
+		case Kind::Star:return "star";
+		case Kind::Spiral:return "spiral";
+		case Kind::Comb:return "comb";
+		case Kind::Zigzag:return "zigzag";
+		}
+
+		return {};
+	}
+
+	inline void index(std::vector<obj::Point>& polygon)
+	{
+		for( size_t i = 0; i < polygon.size(); i++ )
+			polygon[i].i = i;
+	}
+
+	inline std::vector<obj::Point> convex(const size_t n)
+	{
+		constexpr double pi = 3.14159265358979323846;
+
+		std::vector<obj::Point> polygon;
+
+		for( size_t i = 0; i < n; i++ )
+		{
+			const auto a = 2.0 * pi * static_cast<double>(i) / static_cast<double>(n);
+
+			polygon.emplace_back(static_cast<float>(std::cos(a)), static_cast<float>(std::sin(a)), 0.0f);
+		}
+
+		index(polygon);
+
+		return polygon;
+	}
+
+	inline std::vector<obj::Point> star(const size_t n)
+	{
+		constexpr double pi = 3.14159265358979323846;
+
+		std::vector<obj::Point> polygon;
+
+		for( size_t i = 0; i < n; i++ )
+		{
+			const auto a = 2.0 * pi * static_cast<double>(i) / static_cast<double>(n);
+			const auto r = i % 2 == 0 ? 1.0 : 0.5;
+
+			polygon.emplace_back(static_cast<float>(r * std::cos(a)), static_cast<float>(r * std::sin(a)), 0.0f);
+		}
+
+		index(polygon);
+
+		return polygon;
+	}
+
+	inline std::vector<obj::Point> spiral(const size_t n) // Up to two turns wide strip, out along one side and back along the other
+	{
+		constexpr double pi = 3.14159265358979323846;
+
+		const double turns = std::min(2.0, static_cast<double>(n) / 16.0); // At least eight corners per turn and side
+		const double width = 0.5;
+
+		const auto half = n / 2;
+		const auto rest = n - half;
+
+		std::vector<obj::Point> polygon;
+
+		const auto at = [&](const double t, const double offset)
+		{
+			const auto a = 2.0 * pi * turns * t;
+			const auto r = 1.0 + 0.3 * a + offset;
+
+			polygon.emplace_back(static_cast<float>(r * std::cos(a)), static_cast<float>(r * std::sin(a)), 0.0f);
+		};
+
+		for( size_t i = 0; i < rest; i++ )
+			at(rest > 1 ? static_cast<double>(i) / static_cast<double>(rest - 1) : 0.0, width);
+
+		for( size_t i = 0; i < half; i++ )
+			at(half > 1 ? 1.0 - static_cast<double>(i) / static_cast<double>(half - 1) : 1.0, 0.0);
+
+		index(polygon);
+
+		return polygon;
+	}
+
+	inline std::vector<obj::Point> comb(const size_t n) // Base bar with (n - 2) / 4 teeth, padded with points on the base
+	{
+		const auto teeth = n >= 6 ? (n - 2) / 4 : 1;
+
+		const auto w = static_cast<float>(teeth);
+
+		std::vector<obj::Point> polygon;
+
+		const auto pad = n > 2 + 4 * teeth ? n - 2 - 4 * teeth : 0;
+
+		polygon.emplace_back(0.0f, 0.0f, 0.0f);
+
+		for( size_t i = 1; i <= pad; i++ )
+			polygon.emplace_back(w * static_cast<float>(i) / static_cast<float>(pad + 1), 0.0f, 0.0f);
+
+		polygon.emplace_back(w, 0.0f, 0.0f);
+
+		for( size_t t = teeth; t-- > 0; )
+		{
+			const auto x = static_cast<float>(t);
+
+			polygon.emplace_back(x + 1.0f, 2.0f, 0.0f);
+			polygon.emplace_back(x + 0.5f, 2.0f, 0.0f);
+			polygon.emplace_back(x + 0.5f, 1.0f, 0.0f);
+			polygon.emplace_back(x + 0.0f, 1.0f, 0.0f);
+		}
+
+		index(polygon);
+
+		return polygon;
+	}
+
+	inline std::vector<obj::Point> zigzag(const size_t n) // Monotone along x, both chains bend in and out
+	{
+		const auto lower = n - n / 2;
+		const auto upper = n / 2;
+
+		const auto w = static_cast<float>(lower - 1);
+
+		std::vector<obj::Point> polygon;
+
+		for( size_t i = 0; i < lower; i++ )
+			polygon.emplace_back(static_cast<float>(i), i % 2 == 0 ? 0.0f : 0.5f, 0.0f);
+
+		for( size_t i = 0; i < upper; i++ )
+			polygon.emplace_back(w * static_cast<float>(upper - i) / static_cast<float>(upper + 1), i % 2 == 0 ? 2.0f : 1.5f, 0.0f);
+
+		index(polygon);
+
+		return polygon;
+	}
+
+	inline std::vector<obj::Point> make(const Kind kind, const size_t n)
+	{
+		switch( kind )
+		{
+		case Kind::Convex:return convex(n);
+		case Kind::Star:return star(n);
+		case Kind::Spiral:return spiral(n);
+		case Kind::Comb:return comb(n);
+		case Kind::Zigzag:return zigzag(n);
+		}
+
+		return {};
+	}
+
+	inline std::vector<obj::Point> random(const size_t n, Random& random) // Star shaped around the origin, so always simple for n > 3
+	{
+		constexpr double pi = 3.14159265358979323846;
+
+		std::vector<obj::Point> polygon;
+
+		for( size_t i = 0; i < n; i++ ) // One corner per sector keeps every angular gap below half a turn
+		{
+			const auto a = 2.0 * pi * (static_cast<double>(i) + 0.9 * random.real()) / static_cast<double>(n);
+			const auto r = 0.2 + random.real();
+
+			polygon.emplace_back(static_cast<float>(r * std::cos(a)), static_cast<float>(r * std::sin(a)), 0.0f);
+		}
+
+		index(polygon);
+
+		return polygon;
+	}
+
+	inline void place(std::vector<obj::Point>& polygon, Random& random) // Random rotation, scale and offset in 3D
+	{
+		constexpr double pi = 3.14159265358979323846;
+
+		const auto a = 2.0 * pi * random.real();
+		const auto b = pi * random.real();
+		const auto s = std::pow(10.0, 4.0 * random.real() - 2.0);
+
+		const auto ca = std::cos(a), sa = std::sin(a);
+		const auto cb = std::cos(b), sb = std::sin(b);
+
+		const auto dx = 100.0 * (random.real() - 0.5);
+		const auto dy = 100.0 * (random.real() - 0.5);
+		const auto dz = 100.0 * (random.real() - 0.5);
+
+		for( auto& point : polygon )
+		{
+			const auto x = s * point.x, y = s * point.y, z = s * point.z;
+
+			const auto x1 = ca * x - sa * y;
+			const auto y1 = sa * x + ca * y;
+
+			const auto y2 = cb * y1 - sb * z;
+			const auto z2 = sb * y1 + cb * z;
+
+			point.x = static_cast<float>(x1 + dx);
+			point.y = static_cast<float>(y2 + dy);
+			point.z = static_cast<float>(z2 + dz);
+		}
+	}
+}
@@ -0,0 +1,228 @@
+#pragma once
+/*
+  srv.h - Daemon mode, conversion jobs sent over a Unix domain socket
+
+  NB: TriangulateOBJ.h has no dependencies to this file, only main.cpp is using it.
+
+  One obj::Triangulate serves every job, so its worker threads, batch buffer and
+  vertex stores are created by the first job and reused by the next ones. A job
+  holds the arguments of a command line and is run as that command line would be;
+  the answer holds the metrics JSON and everything the conversion printed. Each
+  connection is served by its own thread, the jobs run one at a time and each one
+  has the whole worker pool. The buffers keep the capacity of the largest job.
+
+  Copyright (c) 2023 FalconCoding
+
+  This software is released under the terms of the
+  GNU General Public License v3.0. Details and terms of this
+  license can be found at: https://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+#include <filesystem>
+#include <condition_variable>
+
+#include "cmd.h"
+#include "div.h"
+#include "out.h"
+#include "net.h"
+
+#include "TriangulateOBJ.h"
+
+#ifndef _WIN32
+#include <poll.h>
+#endif
+
+using Job = std::function<bool()>; // Converts with the files and options of the arguments, true when triangulated
+
+#ifndef _WIN32
+
+inline net::Response run(const net::Request& request, obj::Triangulate& obj, const Job& job, const size_t number)
+{
+	net::Response response;
+
+	std::ostringstream log;
+
+	auto* console = std::cout.rdbuf(log.rdbuf());
+
+	std::error_code error;
+
+	const auto directory = std::filesystem::current_path(error);
+
+	std::filesystem::current_path(request.directory, error);
+
+	std::vector<std::string> arguments = {"TriangulateOBJ"};
+
+	Path spool; // Inline source, written to a temporary file for the job
+
+	bool ready(true);
+
+	if( !request.source.empty() )
+	{
+		spool = std::filesystem::temp_directory_path(error) / ("TriangulateOBJ-" + std::to_string(getpid()) + "-" + std::to_string(number) + ".obj");
+
+		std::ofstream file(spool, std::ios::binary);
+
+		file.write(request.source.data(), static_cast<std::streamsize>(request.source.size()));
+
+		if( !file.flush() )
+		{
+			std::cout << "Error: Could not write the inline source to " << spool.string() << std::endl;
+
+			ready = false;
+		}
+
+		arguments.push_back(spool.string());
+	}
+
+	arguments.insert(arguments.end(), request.arguments.begin(), request.arguments.end());
+
+	std::vector<char*> argv;
+
+	for( auto& argument : arguments )
+		argv.push_back(argument.data());
+
+	defaults();
+
+	if( ready && arg(static_cast<int>(argv.size()), argv.data()) )
+	{
+		if( !serve_socket.empty() || !watch_folder.empty() || !calibrate_file.empty() )
+			std::cout << "Error argument: --serve, --watch and --calibrate are not job options" << std::endl;
+		else if( !spool.empty() && target.parent_path() == spool.parent_path() )
+			std::cout << "Error: An inline source needs a target file" << std::endl;
+		else
+		{
+			response.ok      = job();
+			response.metrics = metrics_text(obj, response.ok);
+		}
+	}
+
+	if( !spool.empty() ) std::filesystem::remove(spool, error);
+
+	std::filesystem::current_path(directory, error);
+
+	std::cout.rdbuf(console);
+
+	response.log = log.str();
+
+	return response;
+}
+
+inline bool serve(const Path& path, obj::Triangulate& obj, const Job& job)
+{
+	const auto socket = path.string(); // The path may be an option, and the jobs clear the options
+
+	const int listener = net::listen(socket);
+
+	if( listener < 0 )
+	{
+		std::cout << "Error: Could not listen on the socket " << socket << std::endl;
+
+		return false;
+	}
+
+	catch_interrupt();
+
+	signal(SIGPIPE, SIG_IGN); // A client that hangs up fails the write instead
+
+	std::cout << "Serving jobs on " << socket << std::endl;
+
+	std::mutex running; // One job at a time, each job has the whole worker pool
+
+	size_t jobs(0);
+
+	std::atomic<bool> stop{false};
+
+	std::mutex mutex;
+	std::condition_variable idle;
+	std::vector<int> clients;
+
+	const auto connection = [&](const int fd)
+	{
+		net::Stream stream(fd);
+
+		net::Request request;
+
+		while( !stop && net::receive(stream, request) )
+		{
+			if( request.stop )
+			{
+				stop = true;
+
+				net::send(stream, net::Response{true, {}, "Stopped\n"});
+
+				break;
+			}
+
+			net::Response response;
+
+			{
+				std::lock_guard<std::mutex> lock(running);
+
+				response = run(request, obj, job, ++jobs);
+			}
+
+			if( !net::send(stream, response) ) break;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		clients.erase(std::find(clients.begin(), clients.end(), fd));
+
+		close(fd);
+
+		idle.notify_all();
+	};
+
+	while( !stop && !interrupted )
+	{
+		pollfd wait = {listener, POLLIN, 0};
+
+		if( poll(&wait, 1, 200) <= 0 ) continue; // Checks the stop flags 5 times a second
+
+		const int fd = accept(listener, nullptr, nullptr);
+
+		if( fd < 0 ) continue;
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		clients.push_back(fd);
+
+		std::thread(connection, fd).detach();
+	}
+
+	std::unique_lock<std::mutex> lock(mutex);
+
+	for( const auto fd : clients ) // Wakes the connections waiting for their next job, a running job still gets its answer
+		shutdown(fd, SHUT_RD);
+
+	idle.wait(lock, [&] { return clients.empty(); });
+
+	close(listener);
+
+	unlink(socket.c_str());
+
+	std::cout << "Served " << jobs << " jobs" << std::endl;
+
+	return true;
+}
+
+#else
+
+inline bool serve(const Path&, obj::Triangulate&, const Job&)
+{
+	std::cout << "Error: --serve needs Unix domain sockets, not available on this platform" << std::endl;
+
+	return false;
+}
+
+#endif
@@ -0,0 +1,680 @@
+/*
+  validate.cpp - Differential validation of the triangulation strategies in TriangulateOBJ.h
+
+  Copyright (c) 2023 FalconCoding
+
+  This software is released under the terms of the
+  GNU General Public License v3.0. Details and terms of this
+  license can be found at: https://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+/*
+  -[Possible command arguments]---------------------------------------------------------
+
+   TriangulateOBJ_validate                                  (generated shapes + bundled ObjFiles)
+   TriangulateOBJ_validate --objfiles c:\temp\objfiles      (other directory with obj files)
+   TriangulateOBJ_validate --fuzz 100000 --seed 7           (random polygons as well)
+
+   Every strategy is checked on every polygon it applies to:
+
+     - it produces n - 2 triangles
+     - every triangle corner is a corner of the polygon, with the same coordinates
+     - no triangle uses the same corner twice
+     - all triangles wind the same way as the polygon
+     - the triangle areas add up to the polygon area, and to the area of the reference
+
+   Shapes of 4096 and 8192 corners are converted with Triangulate::split(), split and triangulated on every thread,
+   and the triangles read back from the target get the same checks.
+
+   Polygons random testing once failed on are checked every run.
+
+   Face indices past 2^31 and 2^32 are parsed, and indices that do not fit obj::Index are rejected.
+
+   The exit code is 1 if any check failed.
+
+  --------------------------------------------------------------------------------------
+*/
+
+#include <map>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <iostream>
+#include <filesystem>
+#include <functional>
+
+#include "shape.h"
+#include "TriangulateOBJ.h"
+
+#ifndef OBJ_FILES
+#define OBJ_FILES "ObjFiles"
+#endif
+
+using Polygon   = std::vector<obj::Point>;
+using Triangles = std::vector<obj::Triangle>;
+
+struct Strategy
+{
+	std::string name;
+
+	std::function<bool(const Polygon&, const obj::Point&, bool convex)> applies;
+
+	std::function<Triangles(Polygon&, const obj::Point&)> run;
+};
+
+static const auto any = [](const Polygon&, const obj::Point&, bool) { return true; };
+
+static const obj::Selection forced[] = {{1000000, 0, 0}, {0, 5, 0}, {0, 0, 5}, {0, 0, 0}}; // Every polygon to cut, sweep, grid and clip
+
+static const std::vector<Strategy> strategies =
+{
+	{"cutTriangulation", any, [](Polygon& polygon, const obj::Point& normal) { return obj::cutTriangulation(polygon, normal); }},
+	{"fanTriangulation", [](const Polygon&, const obj::Point&, bool convex) { return convex; }, [](Polygon& polygon, const obj::Point&) { return obj::fanTriangulation(polygon); }},
+	{"quadTriangulation", [](const Polygon& polygon, const obj::Point&, bool) { return polygon.size() == 4; }, [](Polygon& polygon, const obj::Point&) { return obj::quadTriangulation(polygon); }},
+	{"clipTriangulation", any, [](Polygon& polygon, const obj::Point& normal) { return obj::clipTriangulation(polygon, normal); }},
+	{"gridTriangulation", any, [](Polygon& polygon, const obj::Point& normal) { return obj::gridTriangulation(polygon, normal); }},
+	{"sweepTriangulation", [](const Polygon& polygon, const obj::Point& normal, bool) { return obj::monotone(polygon, normal); }, [](Polygon& polygon, const obj::Point& normal) { return obj::sweepTriangulation(polygon, normal); }},
+	{"triangulate", any, [](Polygon& polygon, const obj::Point&) { return obj::triangulate(polygon); }},
+	{"triangulate/adaptive", any, [](Polygon& polygon, const obj::Point&) { return obj::triangulate(polygon, obj::Selection()); }},
+	{"triangulate/cut", any, [](Polygon& polygon, const obj::Point&) { return obj::triangulate(polygon, forced[0]); }},
+	{"triangulate/sweep", any, [](Polygon& polygon, const obj::Point&) { return obj::triangulate(polygon, forced[1]); }},
+	{"triangulate/grid", any, [](Polygon& polygon, const obj::Point&) { return obj::triangulate(polygon, forced[2]); }},
+	{"triangulate/clip", any, [](Polygon& polygon, const obj::Point&) { return obj::triangulate(polygon, forced[3]); }},
+	{"split", any, [](Polygon& polygon, const obj::Point& normal) // Pieces of 8 corners or less, each triangulated on its own
+	{
+		Triangles triangles;
+
+		for( auto& piece : obj::split(polygon, normal, 8) )
+		{
+			const auto part = obj::triangulate(piece, obj::Selection());
+
+			triangles.insert(triangles.end(), part.begin(), part.end());
+		}
+
+		return triangles;
+	}},
+};
+
+struct Options
+{
+	std::string objfiles = OBJ_FILES;
+
+	size_t fuzz = 0;
+
+	uint64_t seed = 1;
+
+	bool verbose = false;
+};
+
+struct Tally
+{
+	size_t polygons = 0;
+	size_t checks   = 0;
+	size_t failures = 0;
+};
+
+inline double area(const obj::Point& a, const obj::Point& b, const obj::Point& c, const obj::Point& normal) // Signed, along the normal
+{
+	const auto u = obj::Point(b.x - a.x, b.y - a.y, b.z - a.z);
+	const auto v = obj::Point(c.x - a.x, c.y - a.y, c.z - a.z);
+
+	const double x = static_cast<double>(u.y) * v.z - static_cast<double>(u.z) * v.y;
+	const double y = static_cast<double>(u.z) * v.x - static_cast<double>(u.x) * v.z;
+	const double z = static_cast<double>(u.x) * v.y - static_cast<double>(u.y) * v.x;
+
+	return 0.5 * (x * normal.x + y * normal.y + z * normal.z);
+}
+
+inline double area(const Polygon& polygon, const obj::Point& normal) // Signed, along the normal
+{
+	double sum(0.0);
+
+	for( size_t i = 1; i + 1 < polygon.size(); i++ )
+		sum += area(polygon[0], polygon[i], polygon[i + 1], normal);
+
+	return sum;
+}
+
+inline double area(const Triangles& triangles, const obj::Point& normal)
+{
+	double sum(0.0);
+
+	for( const auto& t : triangles )
+		sum += area(t.p0, t.p1, t.p2, normal);
+
+	return sum;
+}
+
+inline std::string check(const Polygon& polygon, const obj::Point& normal, const Triangles& triangles, const double reference)
+{
+	if( triangles.size() != polygon.size() - 2 )
+		return "triangle count " + std::to_string(triangles.size()) + ", expected " + std::to_string(polygon.size() - 2);
+
+	std::map<size_t, const obj::Point*> corner;
+
+	for( const auto& point : polygon )
+		corner[point.i] = &point;
+
+	const auto known = [&](const obj::Point& p)
+	{
+		const auto find = corner.find(p.i);
+
+		return find != corner.end() && find->second->x == p.x && find->second->y == p.y && find->second->z == p.z;
+	};
+
+	const auto expected = area(polygon, normal);
+
+	const auto scale = std::max(std::fabs(expected), 1e-12);
+
+	for( const auto& t : triangles )
+	{
+		if( !known(t.p0) || !known(t.p1) || !known(t.p2) )
+			return "triangle corner is not a polygon corner";
+
+		if( t.p0.i == t.p1.i || t.p1.i == t.p2.i || t.p0.i == t.p2.i )
+			return "triangle uses a corner twice";
+
+		const auto a = area(t.p0, t.p1, t.p2, normal);
+
+		if( a * expected < 0.0 && std::fabs(a) > 1e-4 * scale ) // Collinear corners give slivers of either sign at float precision
+			return "triangle winds against the polygon";
+	}
+
+	const auto sum = area(triangles, normal);
+
+	if( std::fabs(sum - expected) > 1e-3 * scale )
+		return "area " + std::to_string(sum) + ", polygon area " + std::to_string(expected);
+
+	if( reference != 0.0 && std::fabs(sum - reference) > 1e-3 * scale )
+		return "area " + std::to_string(sum) + ", reference area " + std::to_string(reference);
+
+	return {};
+}
+
+inline void print(const Polygon& polygon)
+{
+	for( const auto& p : polygon )
+		printf("         v %.9g %.9g %.9g\n", p.x, p.y, p.z);
+}
+
+inline void validate(const std::string& name, Polygon polygon, const Options& options, Tally& tally)
+{
+	obj::removeConsecutiveEqualItems(polygon);
+
+	if( polygon.size() < 3 ) return;
+
+	tally.polygons++;
+
+	const auto normal = obj::normal(polygon);
+
+	const auto convex = obj::convex(polygon, normal);
+
+	double reference(0.0);
+
+	for( const auto& strategy : strategies )
+	{
+		if( !strategy.applies(polygon, normal, convex) ) continue;
+
+		auto copy = polygon;
+
+		const auto triangles = strategy.run(copy, normal);
+
+		const auto failure = check(polygon, normal, triangles, reference);
+
+		if( &strategy == &strategies.front() && failure.empty() )
+			reference = area(triangles, normal);
+
+		tally.checks++;
+
+		if( failure.empty() )
+		{
+			if( options.verbose )
+				std::cout << "ok       " << strategy.name << " " << name << std::endl;
+
+			continue;
+		}
+
+		tally.failures++;
+
+		std::cout << "FAILED   " << strategy.name << " " << name << " (" << polygon.size() << " corners): " << failure << std::endl;
+
+		if( polygon.size() <= 64 ) print(polygon);
+	}
+}
+
+inline void validate(const std::filesystem::path& file, const Options& options, Tally& tally)
+{
+	FILE* source = fopen(file.string().c_str(), "rb");
+
+	if( source == nullptr ) return;
+
+	std::vector<obj::Point> vertex;
+
+	obj::Count count;
+
+	std::string buff;
+
+	size_t number(0);
+
+	while( obj::readline(source, buff) )
+	{
+		number++;
+
+		const char* line = obj::trim(buff.data());
+
+		if( *line == 'v' && *(line + 1) == ' ' )
+		{
+			obj::Point point;
+
+			if( obj::parse(line + 2, point, count) )
+				vertex.emplace_back(point);
+		}
+
+		if( *line != 'f' || *(line + 1) != ' ' ) continue;
+
+		std::vector<obj::Index> indices;
+
+		if( !obj::parse(line + 2, indices, vertex.size()) || indices.size() < 3 ) continue;
+
+		Polygon polygon;
+
+		for( const auto index : indices )
+		{
+			if( index >= 0 && static_cast<size_t>(index) < vertex.size() )
+				polygon.emplace_back(vertex[index]);
+		}
+
+		validate(file.filename().string() + ":" + std::to_string(number), polygon, options, tally);
+	}
+
+	fclose(source);
+}
+
+inline bool load(const std::string& file, std::vector<obj::Point>& vertex, std::vector<Polygon>& faces) // Vertices and faces with absolute indices
+{
+	FILE* source = fopen(file.c_str(), "rb");
+
+	if( source == nullptr ) return false;
+
+	obj::Count count;
+
+	std::string buff;
+
+	while( obj::readline(source, buff) )
+	{
+		const char* line = obj::trim(buff.data());
+
+		if( *line == 'v' && *(line + 1) == ' ' )
+		{
+			obj::Point point;
+
+			if( obj::parse(line + 2, point, count) )
+				vertex.emplace_back(point);
+		}
+
+		std::vector<obj::Index> indices;
+
+		if( *line != 'f' || *(line + 1) != ' ' || !obj::parse(line + 2, indices, vertex.size()) ) continue;
+
+		faces.emplace_back();
+
+		for( const auto index : indices )
+		{
+			if( index >= 0 && static_cast<size_t>(index) < vertex.size() )
+				faces.back().emplace_back(vertex[index]);
+		}
+	}
+
+	fclose(source);
+
+	return true;
+}
+
+inline void validate_split(const Options& options, Tally& tally) // Whole conversions, a single shape in the file
+{
+	const auto folder = std::filesystem::temp_directory_path();
+
+	const auto source = (folder / "TriangulateOBJ_validate.obj").string();
+	const auto target = (folder / "TriangulateOBJ_validate.triangulated.obj").string();
+
+	const size_t sizes[] = {4096, 8192}; // The serial engines lose the spiral's winding from about 12k corners at float precision
+
+	for( const auto kind : shape::kinds )
+	{
+		for( const auto size : sizes )
+		{
+			const auto name = "split/" + shape::name(kind) + "/" + std::to_string(size);
+
+			FILE* file = fopen(source.c_str(), "wb");
+
+			if( file == nullptr ) return;
+
+			for( const auto& p : shape::make(kind, size) )
+				fprintf(file, "v %.17g %.17g %.17g\n", static_cast<double>(p.x), static_cast<double>(p.y), static_cast<double>(p.z));
+
+			fprintf(file, "f");
+
+			for( size_t index = 1; index <= size; index++ )
+				fprintf(file, " %zu", index);
+
+			fprintf(file, "\n");
+			fclose(file);
+
+			obj::Triangulate converter;
+
+			converter.split(256);
+			converter.adapt(true);
+
+			std::vector<obj::Point> vertex;
+			std::vector<Polygon> polygon, triangle;
+
+			tally.polygons++;
+			tally.checks++;
+
+			std::string failure;
+
+			if( !converter.triangulate(source, target) || !load(source, vertex, polygon) || polygon.size() != 1 )
+				failure = "conversion failed";
+			else if( converter.profile().divided != 1 )
+				failure = "not split";
+			else
+			{
+				vertex.clear();
+
+				load(target, vertex, triangle);
+
+				Triangles triangles;
+
+				for( const auto& face : triangle )
+				{
+					if( face.size() == 3 )
+						triangles.emplace_back(face[0], face[1], face[2]);
+				}
+
+				obj::removeConsecutiveEqualItems(polygon.front());
+
+				failure = check(polygon.front(), obj::normal(polygon.front()), triangles, 0.0);
+			}
+
+			if( failure.empty() )
+			{
+				if( options.verbose )
+					std::cout << "ok       " << name << " (" << converter.profile().pieces << " pieces)" << std::endl;
+
+				continue;
+			}
+
+			tally.failures++;
+
+			std::cout << "FAILED   " << name << ": " << failure << std::endl;
+		}
+	}
+
+	std::remove(source.c_str());
+	std::remove(target.c_str());
+}
+
+inline void validate_indices(const Options& options, Tally& tally) // Face indices past 2^31 and 2^32, without a file that large
+{
+	struct Case
+	{
+		const char* line;
+
+		uint64_t vertices;
+
+		std::vector<int64_t> expected; // Empty when the face is rejected
+	};
+
+	constexpr bool wide = sizeof(obj::Index) == 8;
+
+	const std::vector<Case> cases =
+	{
+		{"1 2 -1", 3, {0, 1, 2}},
+		{"2147483647 2147483648 -1", 4'000'000'000ull, wide ? std::vector<int64_t>{2147483646, 2147483647, 3999999999} : std::vector<int64_t>{}},
+		{"5000000000 -5000000000 -1", 6'000'000'000ull, wide ? std::vector<int64_t>{4999999999, 1000000000, 5999999999} : std::vector<int64_t>{}},
+		{"1 99999999999999999999 3", 3, {}},
+	};
+
+	for( const auto& item : cases )
+	{
+		std::vector<obj::Index> indices;
+
+		const auto parsed = obj::parse(item.line, indices, static_cast<size_t>(item.vertices));
+
+		tally.checks++;
+
+		if( (item.expected.empty() && !parsed) || (parsed && std::vector<int64_t>(indices.begin(), indices.end()) == item.expected) )
+		{
+			if( options.verbose )
+				std::cout << "ok       indices \"f " << item.line << "\"" << std::endl;
+
+			continue;
+		}
+
+		tally.failures++;
+
+		std::cout << "FAILED   indices \"f " << item.line << "\" with " << item.vertices << " vertices" << std::endl;
+	}
+}
+
+inline std::string contents(const std::string& file) // Whole file, empty when missing
+{
+	std::ifstream stream(file, std::ios::binary);
+
+	return std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+}
+
+inline void validate_lazy(const Options& options, Tally& tally) // Lazy vertices number and drop v lines as eager parsing does
+{
+	const auto folder = std::filesystem::temp_directory_path();
+
+	const auto source = (folder / "TriangulateOBJ_validate_lazy.obj").string();
+	const auto eager = (folder / "TriangulateOBJ_validate_lazy.eager.obj").string();
+	const auto lazy = (folder / "TriangulateOBJ_validate_lazy.lazy.obj").string();
+
+	FILE* file = fopen(source.c_str(), "wb");
+
+	if( file == nullptr ) return;
+
+	fprintf(file, "v 0 0 0\nv 1 0 0\nv bad 1 0\nv 1 1 0\nv 1a 2 3\nv 0.5 2 0\nv 1 2 .\nv 0 1 0\nv  2 3\nf 1 3 4 6 5\n");
+	fclose(file);
+
+	std::string failure;
+
+	obj::Triangulate first, second;
+
+	second.lazy(true);
+
+	if( !first.triangulate(source, eager) || !second.triangulate(source, lazy) )
+		failure = "conversion failed";
+	else if( contents(eager) != contents(lazy) )
+		failure = "lazy output differs from eager";
+
+	tally.polygons++;
+	tally.checks++;
+
+	if( failure.empty() )
+	{
+		if( options.verbose )
+			std::cout << "ok       lazy" << std::endl;
+	}
+	else
+	{
+		tally.failures++;
+
+		std::cout << "FAILED   lazy: " << failure << std::endl;
+	}
+
+	std::remove(source.c_str());
+	std::remove(eager.c_str());
+	std::remove(lazy.c_str());
+}
+
+inline void validate_verbatim(const Options& options, Tally& tally) // Triangles copied as they are still drop the lines a parsed face drops
+{
+	const auto folder = std::filesystem::temp_directory_path();
+
+	const auto source = (folder / "TriangulateOBJ_validate_verbatim.obj").string();
+	const auto target = (folder / "TriangulateOBJ_validate_verbatim.triangulated.obj").string();
+
+	FILE* file = fopen(source.c_str(), "wb");
+
+	if( file == nullptr ) return;
+
+	fprintf(file, "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nf 1 2 3\nf 1 2 99\nf 0 1 2\nf 1 1 2\nf 1 2 x\nf -1 -2 -9\nf 1 -1 4\nf 1 3 4\nf 1 2 3 4\n");
+	fclose(file);
+
+	const std::vector<std::string> expected = {"f 1 2 3", "f 1 3 4", "f 1 2 3", "f 1 3 4"};
+
+	std::vector<std::string> faces;
+
+	obj::Triangulate converter;
+
+	std::string failure;
+
+	if( !converter.triangulate(source, target) )
+		failure = "conversion failed";
+	else
+	{
+		std::ifstream stream(target, std::ios::binary);
+
+		for( std::string line; std::getline(stream, line); )
+		{
+			if( line.compare(0, 2, "f ") == 0 )
+				faces.emplace_back(line);
+		}
+
+		if( faces != expected )
+			failure = std::to_string(faces.size()) + " faces written, expected " + std::to_string(expected.size());
+	}
+
+	tally.polygons++;
+	tally.checks++;
+
+	if( failure.empty() )
+	{
+		if( options.verbose )
+			std::cout << "ok       verbatim" << std::endl;
+	}
+	else
+	{
+		tally.failures++;
+
+		std::cout << "FAILED   verbatim: " << failure << std::endl;
+	}
+
+	std::remove(source.c_str());
+	std::remove(target.c_str());
+}
+
+inline void validate_regressions(const Options& options, Tally& tally) // Polygons the fuzzer once failed on, named by seed and number
+{
+	struct Case
+	{
+		const char* name;
+
+		Polygon polygon;
+	};
+
+	std::vector<Case> cases =
+	{
+		{"fuzz/1/4630", {{-33.677887f, 32.3383827f, 32.9656029f}, {-33.6458397f, 32.2661858f, 33.0527191f}, {-33.5616341f, 32.0772476f, 33.2806892f}, {-33.8914719f, 32.1840897f, 33.1517715f}, {-34.173893f, 32.4152946f, 32.8728027f}, {-33.9874306f, 32.5397682f, 32.7226181f}}},
+		{"fuzz/1/6383", {{43.4341621f, -49.2033501f, -33.2362976f}, {43.4403725f, -49.1951675f, -33.2399216f}, {43.446579f, -49.186985f, -33.2435493f}, {43.4512253f, -49.1959915f, -33.2395554f}, {43.4558716f, -49.2050018f, -33.2355652f}, {43.445015f, -49.204174f, -33.2359314f}}},
+		{"fuzz/1/12004", {{-33.1026421f, 9.71401691f, -19.9199696f}, {-33.091095f, 9.71355915f, -19.8990154f}, {-33.1274452f, 9.71305847f, -19.8760548f}, {-33.1531525f, 9.71298409f, -19.8726482f}, {-33.1620903f, 9.71265697f, -19.8576622f}, {-33.1739616f, 9.71273136f, -19.8610859f}, {-33.1947632f, 9.71234131f, -19.843214f}, {-33.2046432f, 9.71260548f, -19.8553162f}, {-33.1923141f, 9.71317387f, -19.8813343f}, {-33.2083549f, 9.71333218f, -19.8886166f}, {-33.1972618f, 9.71353149f, -19.8977242f}, {-33.2221375f, 9.71440887f, -19.9379177f}, {-33.1779938f, 9.71383572f, -19.9116745f}, {-33.1532173f, 9.71498013f, -19.9640961f}, {-33.1301003f, 9.71462154f, -19.947691f}}},
+		{"fuzz/1/21654", {{26.9885998f, -47.5620918f, 8.23282528f}, {26.9978561f, -47.5625954f, 8.23248863f}, {27.0071106f, -47.5631027f, 8.23215103f}, {27.0030098f, -47.5561829f, 8.23677444f}, {26.9989071f, -47.5492668f, 8.24139786f}, {26.9937534f, -47.5556793f, 8.23711205f}}},
+	};
+
+	for( auto& item : cases ) // Small triangles with a corner on every edge, one of them bent in by rounding, and a thin polygon split by split()
+	{
+		shape::index(item.polygon);
+
+		validate(std::string("regression/") + item.name, item.polygon, options, tally);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Options options;
+
+	for( int i = 1; i < argc; i++ )
+	{
+		const std::string arg = argv[i];
+
+		if( arg == "--objfiles" && i + 1 < argc )
+			options.objfiles = argv[++i];
+		else if( arg == "--fuzz" && i + 1 < argc )
+			options.fuzz = std::strtoull(argv[++i], nullptr, 10);
+		else if( arg == "--seed" && i + 1 < argc )
+			options.seed = std::strtoull(argv[++i], nullptr, 10);
+		else if( arg == "--verbose" )
+			options.verbose = true;
+		else
+		{
+			std::cout << "Error argument: Unknown argument " << arg << std::endl;
+
+			return 1;
+		}
+	}
+
+	Tally tally;
+
+	validate_indices(options, tally);
+
+	validate_split(options, tally);
+
+	validate_lazy(options, tally);
+
+	validate_verbatim(options, tally);
+
+	validate_regressions(options, tally);
+
+	const size_t sizes[] = {3, 4, 5, 6, 8, 16, 64, 256};
+
+	for( const auto kind : shape::kinds )
+	{
+		for( const auto size : sizes )
+		{
+			const auto name = shape::name(kind) + "/" + std::to_string(size);
+
+			validate(name, shape::make(kind, size), options, tally);
+
+			auto reversed = shape::make(kind, size);
+
+			std::reverse(reversed.begin(), reversed.end());
+
+			validate(name + "/reversed", reversed, options, tally);
+		}
+	}
+
+	std::error_code error;
+
+	for( const auto& entry : std::filesystem::directory_iterator(options.objfiles, error) )
+	{
+		if( entry.path().extension() == ".obj" )
+			validate(entry.path(), options, tally);
+	}
+
+	if( error )
+		std::cout << "Warning: Could not read the obj directory " << options.objfiles << std::endl;
+
+	shape::Random random(options.seed);
+
+	for( size_t i = 0; i < options.fuzz; i++ )
+	{
+		const auto n = random.range(3, random.real() < 0.9 ? 16 : 200);
+
+		auto polygon = random.next() % 4 == 0 ? shape::make(shape::kinds[random.range(0, std::size(shape::kinds) - 1)], n) : shape::random(n, random);
+
+		shape::place(polygon, random);
+
+		validate("fuzz/" + std::to_string(options.seed) + "/" + std::to_string(i), polygon, options, tally);
+	}
+
+	std::cout << tally.polygons << " polygons, " << tally.checks << " checks, " << tally.failures << " failed" << std::endl;
+
+	return tally.failures == 0 ? 0 : 1;
+}